@@ -0,0 +1,43 @@
+#ifndef BROADCAST_HPP
+# define BROADCAST_HPP
+
+#pragma once
+
+/* System Includes */
+#include <string>
+
+/* Local Includes */
+#include "Payload.hpp"
+
+/* Class Prototypes */
+class Client;
+
+/* One line sent to many clients, with the IRCv3 server tags (time, msgid) each of them
+ * negotiated. The tags are formatted once, and the line is built at most once for every
+ * set of capabilities found among the recipients, each recipient sharing its Payload. */
+class Broadcast {
+	public:
+		/* Constructors & Destructor */
+		explicit Broadcast(const std::string& line);
+		~Broadcast() { }
+
+		/* Line to queue for a recipient */
+		const Payload&		to(const Client* client);
+
+	private:
+		enum { VARIANTS = 4 };	/* Indexed by the tag capability bits */
+
+		const std::string&	_line;		/* Owned by the caller, outlives the broadcast */
+		Payload				_variants[VARIANTS];
+		std::string			_time;		/* "time=...", empty until a recipient needs tags */
+		std::string			_msgid;		/* "msgid=..." */
+
+		/* Private Member Functions */
+		void				_formatTags();
+
+		/* Non-copyable */
+		Broadcast(const Broadcast&);
+		Broadcast&			operator=(const Broadcast&);
+};
+
+#endif
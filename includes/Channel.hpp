@@ -11,20 +11,23 @@
 #include <string>
 #include <vector>
 
-/* Funtion Prototype */
-const std::string getTimestamp( );
-
 /* Class Definitions */
 class Client;
 
 class Channel
 {
   public:
-	/* Members are stored with their addresses as the key, and their memberModes as the
-	 * value */
+	/* Clients known to the channel without being members are stored with their addresses
+	 * as the key, and their memberModes as the value */
 	typedef uint32_t                  Mode;
 	typedef std::map< Client*, Mode > MemberMap;
 
+	/* Members are kept contiguous, so that broadcasts are a linear scan */
+	struct Member {
+		Client* client;
+		Mode    modes;
+	};
+
 	Channel(const std::string& name, Client* owner);
 	~Channel( ) {}
 
@@ -60,11 +63,18 @@ class Channel
 	bool        isMember(Client* client);
 	void        addMember(Client* client, const std::string& reply, int modes = 0);
 	void        removeMember(Client* client);
+	void        forgetClient(Client* client);
 	void        ensureOperator(void);
 	std::string getMemberList(bool isMember);
-	size_t      getNbVisibleUsers(void) const;
+	const std::vector< std::string >& getNameReplies(const std::string& host, bool isMember);
+	void invalidateNames(void) { _namesValid[0] = _namesValid[1] = false; }
+	void        updateVisibility(bool visible);
 	bool        getIsEmpty( ) const { return _members.empty( ); }
-	std::vector< std::string > getMemberVector(void);
+
+	/* Counters kept up to date on join, part and mode changes, reading them is free */
+	size_t getNbMembers(void) const { return _members.size( ); }
+	size_t getNbVisibleUsers(void) const { return _nbVisible; }
+	size_t getNbOperators(void) const { return _nbOperators; }
 
 	/* Channel Messaging */
 
@@ -76,11 +86,25 @@ class Channel
 	std::string       _password; /* if channel is password protected */
 	std::string       _topic;    /* Channel topic */
 	Client*           _owner;    /* Channel owner */
-	MemberMap         _members;  /* Channel member list, paired with their memberModes */
+	std::vector< Member > _members; /* Channel member list, in no particular order */
+	std::vector< uint32_t >
+	  _memberIndex; /* Open addressing on client address: position in _members + 1, 0 if free */
 	MemberMap
 	     _notMembers; /* Clients with flags set who are not currently in the channel */
 	char _modes;      /* Channel modes */
 	const std::time_t _timeStart; /* Time channel was created */
+	size_t            _nbVisible;   /* Members without user mode +i */
+	size_t            _nbOperators; /* Members with channel mode +o */
+	std::vector< std::string > _names[2]; /* getNameReplies for non-members, then members */
+	bool                       _namesValid[2];
+
+	/* Member storage */
+	size_t        _findSlot(Client* client) const;
+	Member*       _findMember(Client* client);
+	const Member* _findMember(Client* client) const;
+	void          _insertMember(Client* client, Mode modes);
+	void          _eraseMember(Client* client);
+	void          _growIndex(void);
 };
 
 #endif
\ No newline at end of file
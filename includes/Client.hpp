@@ -4,17 +4,36 @@
 #pragma once
 
 /* System Includes */
+#include <deque>
 #include <map>
 #include <string>
+#include <vector>
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <ctime>
 /* Local Includes */
 #include "Channel.hpp"
 #include "Message.hpp"
+#include "Payload.hpp"
+#include "TimerWheel.hpp"
+
+/* Class Prototypes */
+class EventLoop;
 
 class Client {
 	public:
+		/* Outcome of nextLine() */
+		enum LineStatus { NO_LINE, LINE_READY, LINE_TOO_LONG, LINE_MALFORMED };
+
+		/* read() result when the socket had nothing to read, distinct from a disconnection */
+		enum { READ_AGAIN = -2 };
+
+		/* IRCv3 capabilities, stored using bitmask */
+		enum Capability {
+			CAP_MESSAGE_TAGS = 0x1,		/* Tags on messages, msgid among them */
+			CAP_SERVER_TIME  = 0x2		/* time tag on messages */
+		};
+
 		Client(int socket);
 		~Client();
 
@@ -30,6 +49,12 @@ class Client {
 		void				setRegistration(const bool& registration) { _isRegistered = registration; }
 		void 				setAwayMessage(const std::string& awayMessage) {_awayMessage = awayMessage;}
 		void				setPingStatus(const bool& status) { _wasPinged = status; }
+		void				setLastActivityTime(const std::time_t& time) { _timeLastActivity = time; }
+		void				setLastActivityMs(const uint64_t& time) { _msLastActivity = time; }
+		void				setLoop(EventLoop* loop) { _loop = loop; }
+		void				setClosing(const bool& closing) { _isClosing = closing; }
+		void				setPollingOut(const bool& polling) { _isPollingOut = polling; }
+		void				setSendQLimits(size_t unregistered, size_t registered) { _sendQLimits[0] = unregistered; _sendQLimits[1] = registered; }
 		const std::string&	getNickname(void) const { return (_nickname); }
 		const std::string&	getPassword(void) const { return (_password); }
 		const std::string&	getUsername(void) const { return (_username); }
@@ -41,11 +66,24 @@ class Client {
 		bool				getRegistration(void) { return (_isRegistered); }
 		const std::time_t&	getConnectTime(void) const { return (_timeConnect); }
 		const std::time_t&	getLastActivityTime(void) const { return _timeLastActivity; }
+		const uint64_t&		getLastActivityMs(void) const { return _msLastActivity; }
 		const bool&			getPingStatus(void) const { return _wasPinged; }
 		const bool&			getPassStatus(void) const { return _isPassValidated; }
 		void				setPassStatus(const bool& status) { _isPassValidated = status; }
+		void				setCapabilities(const int& capabilities) { _capabilities = capabilities; }
+		int					getCapabilities(void) const { return _capabilities; }
+		void				setNegotiating(const bool& negotiating) { _isNegotiating = negotiating; }
+		bool				isNegotiating(void) const { return _isNegotiating; }
+		EventLoop*			getLoop(void) const { return _loop; }
+		Timer&				getTimer(void) { return _timer; }
+		bool				isClosing(void) const { return _isClosing; }
+		bool				isPollingOut(void) const { return _isPollingOut; }
+		bool				hasPendingOutput(void) const { return !_sendQueue.empty(); }
+		size_t				getSendQueueSize(void) const { return _sendQueueSize; }
+		size_t				getSendQLimit(void) const { return _sendQLimits[_isRegistered]; }
 		
 		const std::string	getAddress() const;			
+		bool				isLoopback() const;
 
 
 		/*************************/
@@ -55,12 +93,26 @@ class Client {
 		bool				checkGlobalModes(const char& mode) const;
 		std::string 		getGlobalModes(void);
 
+		/*************************/
+		/*   Channel Membership  */
+		/*************************/
+		/* Kept up to date by Channel, the only caller of the add and remove functions */
+		const std::vector<Channel*>&	getChannels(void) const { return _channels; }
+		const std::vector<Channel*>&	getFlaggedChannels(void) const { return _flaggedChannels; }
+		void				addChannel(Channel* channel) { _channels.push_back(channel); }
+		void				removeChannel(Channel* channel);
+		void				addFlaggedChannel(Channel* channel) { _flaggedChannels.push_back(channel); }
+		void				removeFlaggedChannel(Channel* channel);
+
 		/************************/
 		/*    I/O Management    */
 		/************************/
 		int					read();
+		int					receive(const char* data, int nbytes);
 		void				reply(const std::string& reply);
-		std::string			retrieveMessage();
+		void				reply(const Payload& reply);
+		void				flush();
+		LineStatus			nextLine(const char*& line, size_t& length);
 
 
 	private:
@@ -70,19 +122,45 @@ class Client {
 		std::string						_realname;
 		std::string						_password;
 		char							_globalModes;		/* Mode flags stored using bitmask */
-		std::string						_inputBuffer;		/* Raw data received from socket reads */
+		char*							_input;				/* Compacting buffer of INPUT_BUFFER_SIZE bytes */
+		size_t							_inputStart;		/* First byte not framed yet */
+		size_t							_inputScan;			/* Where the search for a line ending resumes */
+		size_t							_inputEnd;			/* End of the data received */
+		bool							_isDiscarding;		/* Dropping the rest of an overlong line */
+		std::deque<Payload>				_sendQueue;			/* Replies not yet accepted by the socket */
+		size_t							_sendOffset;		/* Bytes of the front reply already sent */
+		size_t							_sendQueueSize;		/* Bytes left to send */
+		bool							_isPollingOut;		/* Socket is watched for writability */
+		size_t							_sendQLimits[2];	/* Max _sendQueueSize, before and after registration */
+		bool							_isSendQExceeded;	/* Slow consumer waiting to be disconnected */
 		std::string						_awayMessage;
+		std::vector<Channel*>			_channels;			/* Channels joined */
+		std::vector<Channel*>			_flaggedChannels;	/* Channels holding a ban or invite for the client without it being a member */
 		bool							_isRegistered;
 		bool							_isPassValidated;
+		int								_capabilities;		/* Capability flags stored using bitmask */
+		bool							_isNegotiating;		/* CAP LS or REQ seen, registration waits for CAP END */
+		bool							_isClosing;			/* Removed from the server, deleted at the end of the loop iteration */
 
 		/* Time management */
 		const std::time_t				_timeConnect;
 		std::time_t						_timeLastActivity;
+		uint64_t						_msLastActivity;	/* Monotonic, drives the timer */
 		bool							_wasPinged;
+		Timer							_timer;				/* Registration deadline, then ping checks */
 
 		struct sockaddr_in				_address;
 		std::string						_hostname;
 
+		EventLoop*						_loop;				/* Event loop owning the socket */
+
+		/* Private Member Functions */
+		void							_exceedSendQ();
+		void							_compactInput();
+
+		/* Non-copyable */
+		Client(const Client&);
+		Client&							operator=(const Client&);
 };
 
 #endif
\ No newline at end of file
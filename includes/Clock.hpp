@@ -0,0 +1,45 @@
+#ifndef CLOCK_HPP
+# define CLOCK_HPP
+
+#pragma once
+
+/* System Includes */
+#include <cstddef>
+#include <ctime>
+#include <stdint.h>
+
+/* Time sampled once per event loop iteration. Hot paths read these cached values instead
+ * of calling into libc. Each thread has its own copy, refreshed by update(), and a thread
+ * that never called it samples the clock on first use. */
+class Clock {
+	public:
+		/* Sample the clocks for the calling thread */
+		static void			update();
+
+		/* CLOCK_MONOTONIC in milliseconds */
+		static uint64_t		monotonic()		{ _ensure(); return _state.monotonic; }
+		static std::time_t	wall()			{ _ensure(); return _state.wall; }
+		/* CLOCK_REALTIME in milliseconds */
+		static uint64_t		wallMs()		{ _ensure(); return _state.wallMs; }
+
+		/* Log line prefix for wall(), only reformatted when the second changes */
+		static const char*	timestamp();
+
+		/* Write the log line prefix for a given time, returns its length */
+		static size_t		format(std::time_t time, char* out, size_t size);
+
+	private:
+		struct State {
+			uint64_t		monotonic;
+			std::time_t		wall;
+			uint64_t		wallMs;
+			std::time_t		formattedWall;	/* Time the timestamp was formatted for */
+			char			timestamp[48];
+		};
+
+		static __thread State	_state;
+
+		static void			_ensure()		{ if (!_state.monotonic) update(); }
+};
+
+#endif
@@ -7,8 +7,10 @@
 #include <string>
 
 /* Local Includes */
+#include "Logger.hpp"
 #include "Message.hpp"
 #include "Server.hpp"
+#include "Trace.hpp"
 #include "replies.h"
 #include "defines.h"
 
@@ -24,13 +26,16 @@ class Command {
 		/* Operator Overloads */
 
 		/* Setters & Getters */
+		const std::string&	getName() const { return _name; }
+		uint8_t			getId() const { return _id; }
 
 		/* Public Member Functions */
 		virtual void	execute(const Message& msg) = 0;
 
 	protected:
-		Command(const std::string& name, Server * server) : _name(name), _server(server) { }
+		Command(const std::string& name, Server * server) : _name(name), _id(Trace::registerCommand(name)), _server(server) { }
 		const std::string	_name;
+		const uint8_t		_id;			/* Identifies the command in traces */
 		bool				_channelOpRequired;
 		bool				_globalOpRequired;
 		int					_replCode;
@@ -43,6 +48,18 @@ class Command {
 				 + msg._client->getHostname();
 				 //FIXME: DO NOT FORGET TO CHANGE THIS, hardcoded for testing
 		}
+
+		/* Welcome the client once NICK and USER are done, unless CAP negotiation is still going */
+		void				_completeRegistration(const Message& msg) {
+			Client* client = msg._client;
+
+			if (client->getRegistration() || client->isNegotiating()
+				|| client->getUsername().empty() || client->getNickname().empty())
+				return;
+			client->setRegistration(true);
+			client->reply(RPL_WELCOME(_server->getHostname(), client->getNickname(), _buildPrefix(msg)));
+			LOG(CONNECTIONS, INFO, GREEN "New user successfully registered: " CLEAR << client->getNickname());
+		}
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,67 @@
+#ifndef COMMANDTABLE_HPP
+# define COMMANDTABLE_HPP
+
+#pragma once
+
+/* System Includes */
+#include <cstddef>
+#include <stdint.h>
+
+/* Static table of the commands the server knows. Names are resolved with a perfect hash
+ * computed on the fly from case-folded characters, then one case-insensitive compare, so
+ * a lookup never allocates and unknown commands simply come back as UNKNOWN. Each command
+ * also has fixed properties, enforced by the dispatcher before any handler runs. */
+class CommandTable {
+	public:
+		enum Id {
+			UNKNOWN,
+			AWAY,
+			CAP,
+			INVITE,
+			JOIN,
+			KICK,
+			LIST,
+			MODE,
+			NAMES,
+			NICK,
+			NOTICE,
+			PART,
+			PASS,
+			PING,
+			PONG,
+			PRIVMSG,
+			QUIT,
+			SHUTDOWN,
+			TOPIC,
+			TRACEDUMP,
+			USER,
+			WHO,
+			WHOIS,
+			COUNT
+		};
+
+		struct Info {
+			uint8_t			minParams;		/* Middle parameters needed, ERR_NEEDMOREPARAMS below */
+			bool			registered;		/* Refused with ERR_NOTREGISTERED before registration */
+			uint8_t			floodCost;		/* Weight charged to the sender by flood control */
+			bool			readOnly;		/* Leaves server state untouched, safe off the owning loop */
+		};
+
+		static Id			lookup(const char* name, size_t length);
+		static const Info&	info(Id id)		{ return _info[id]; }
+
+	private:
+		struct Entry {
+			const char*		name;
+			Id				id;
+		};
+
+		enum { SLOTS = 32 };
+
+		static const Entry	_slots[SLOTS];
+		static const Info	_info[COUNT];	/* Indexed by Id */
+
+		static size_t		_hash(const char* name, size_t length);
+};
+
+#endif
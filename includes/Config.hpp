@@ -0,0 +1,42 @@
+#ifndef CONFIG_HPP
+# define CONFIG_HPP
+
+#pragma once
+
+/* System Includes */
+#include <cstddef>
+#include <string>
+
+/* Runtime tunables. The command line is fixed to <port> <password>, so everything
+ * else is read from IRC_* environment variables at startup. */
+struct Config {
+	/* Constructors */
+	Config();
+
+	/* Event loop */
+	std::string		reactor;		/* IRC_REACTOR: io_uring, epoll or poll */
+	size_t			threads;		/* IRC_THREADS: number of event loop threads */
+	std::string		cpuAffinity;	/* IRC_CPU_AFFINITY: "none", "auto" or a list of CPUs ("0,2,4") */
+
+	/* Send queue limits in bytes, per connection class */
+	size_t			sendqUnregistered;	/* IRC_SENDQ_UNREGISTERED: clients still registering */
+	size_t			sendqRegistered;	/* IRC_SENDQ: registered clients */
+
+	/* Output */
+	bool			tcpCork;		/* IRC_TCP_CORK: hold partial frames while flushing a client (Linux) */
+
+	/* Administration */
+	std::string		adminPassword;	/* IRC_ADMIN_PASSWORD: lets TRACEDUMP run from other hosts than loopback */
+
+	/* Logging */
+	std::string		logLevel;		/* IRC_LOG_LEVEL: debug, info, warn or error */
+	std::string		logCategories;	/* IRC_LOG: categories to log ("server,connections,commands,io") */
+
+	/* Load settings from the environment, keeping defaults for unset variables */
+	void			loadEnvironment();
+
+	/* CPU the given event loop should be pinned to, or -1 */
+	int				cpuForLoop(size_t loop) const;
+};
+
+#endif
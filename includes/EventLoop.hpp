@@ -0,0 +1,142 @@
+#ifndef EVENTLOOP_HPP
+# define EVENTLOOP_HPP
+
+#pragma once
+
+/* System Includes */
+#include <pthread.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+/* Local Includes */
+#include "Mutex.hpp"
+#include "Payload.hpp"
+#include "Reactor.hpp"
+#include "TimerWheel.hpp"
+#include "Trace.hpp"
+
+/* Class Prototypes */
+class Server;
+class Client;
+
+/* One reactor thread. Each loop owns the sockets of a subset of the clients and is the
+ * only thread to read from or write to them. Replies for a client owned by another loop
+ * are posted to that loop's mailbox, and the loop is woken up through a pipe.
+ * Commands still run under the server-wide lock, one loop at a time: loops add throughput
+ * to socket I/O, reply batching and framing, not to command execution. How long each loop
+ * waits for the lock is counted, for the point where more loops stop helping to show. */
+class EventLoop {
+	public:
+		/* Counters, only written by the loop thread */
+		struct Stats {
+			uint64_t	iterations;		/* Returns from the reactor wait */
+			uint64_t	timeouts;		/* ...with nothing ready, to fire timers */
+			uint64_t	wakeups;		/* ...because another thread woke the loop up */
+			uint64_t	sendqDrops;		/* Clients disconnected for exceeding their send queue limit */
+			uint64_t	commands;		/* Messages received from clients */
+			uint64_t	recvCalls;
+			uint64_t	sendCalls;		/* Gathered writes, successful or not */
+			uint64_t	corkCalls;		/* TCP_CORK toggles */
+			uint64_t	bytesOut;
+			uint64_t	lockWaitNs;		/* Spent waiting for the server lock */
+		};
+
+		/* Constructors & Destructor */
+		EventLoop(Server* server, size_t id, const std::string& backend, int cpu);
+		~EventLoop();
+
+		/* Setters & Getters */
+		size_t						getId() const			{ return _id; }
+		const char*					getBackendName() const	{ return _reactor->getName(); }
+		const Stats&				getStats() const		{ return _stats; }
+		Stats&						getStats()				{ return _stats; }
+		Trace&						getTrace()				{ return _trace; }
+
+		/* Loop currently running on the calling thread, if any */
+		static EventLoop*			current();
+
+		/*************************/
+		/*     Loop Operation    */
+		/*************************/
+		void						start();
+		void						join();
+		void						run();
+		void						wake();
+		void						requestTraceDump();
+		void						logStats() const;
+
+		/*************************/
+		/*   Socket Management   */
+		/*************************/
+		void						listen(int fd);
+		void						pauseAccept();
+		void						watch(Client* client);
+		void						discard(Client* client);
+		void						updateInterest(Client* client);
+		void						scheduleFlush(Client* client);
+		void						evict(Client* client);
+		void						schedule(Client* client, uint64_t when);
+
+		/*************************/
+		/*   Cross-loop Mailbox  */
+		/*************************/
+		void						adopt(Client* client);
+		void						post(Client* client, const Payload& data);
+
+	private:
+		/* Mailbox entry: either a new client to watch, or data to send to a client */
+		struct Delivery {
+			Client*		client;
+			Payload		data;
+			bool		adopt;
+		};
+
+		Server*						_server;
+		const size_t				_id;
+		Reactor*					_reactor;
+		pthread_t					_thread;
+		bool						_hasThread;
+		const int					_cpu;			/* CPU to pin the loop to, -1 if unpinned */
+		const bool					_cork;			/* Cork sockets while flushing them */
+		int							_listenFd;
+		bool						_listening;		/* The listener is watched by the reactor */
+		Timer						_acceptTimer;	/* Pending while accepting is paused */
+		int							_wakeFds[2];	/* Pipe written to by other threads */
+		TimerWheel					_timers;		/* Timers of the clients owned by this loop */
+		Stats						_stats;
+		Trace						_trace;			/* Flight recorder, only written by the loop thread */
+		int							_traceDumpRequested;
+
+		Mutex						_mailboxLock;
+		std::vector<Delivery>		_mailbox;		/* Guarded by _mailboxLock */
+		std::vector<Delivery>		_deliveries;	/* Mailbox contents being processed */
+
+		std::vector<Client*>					_discarded;	/* Clients to delete at the end of the iteration */
+		std::vector<Client*>					_evicted;	/* Slow consumers to disconnect at the end of the iteration */
+		std::vector<Client*>					_flushes;	/* Clients with replies queued during the iteration */
+		std::vector<Reactor::Event>				_events;
+		std::vector<std::pair<Client*, int> >	_reads;	/* Clients read this turn, with read() result */
+		std::vector<int>						_accepted;	/* Sockets accepted by the reactor and not registered yet, or negated errnos */
+		std::vector<int>						_acceptBatch;	/* Those being registered this turn */
+
+		/* Private Member Functions */
+		static void*				_threadMain(void* loop);
+		void						_pin(int cpu);
+		void						_drainWakePipe();
+		void						_registerAccepted();
+		void						_stopAccept();
+		void						_resumeAccept();
+		void						_drainMailbox();
+		void						_dropEvicted();
+		void						_flushReplies();
+		void						_setCork(int fd, int on);
+		void						_reapDiscarded();
+		void						_dumpTrace();
+
+		/* Non-copyable */
+		EventLoop(const EventLoop&);
+		EventLoop&					operator=(const EventLoop&);
+};
+
+#endif
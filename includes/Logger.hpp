@@ -0,0 +1,57 @@
+#ifndef LOGGER_HPP
+# define LOGGER_HPP
+
+#pragma once
+
+/* System Includes */
+#include <sstream>
+#include <string>
+
+/* Class Prototypes */
+struct Config;
+
+/* Log a message if its category is enabled at that level. The message is a stream
+ * expression, nothing is evaluated or formatted when it is filtered out. */
+#define LOG(category, level, message)                                              \
+	do {                                                                           \
+		if (Logger::isEnabled(Logger::category, Logger::level)) {                  \
+			std::ostringstream logStream_;                                         \
+			logStream_ << message;                                                 \
+			Logger::write(Logger::category, Logger::level, logStream_.str( ));     \
+		}                                                                          \
+	} while (0)
+
+/* Process-wide asynchronous logger. Callers push their messages to a bounded lock-free
+ * ring and return, a background thread timestamps them and writes them out. Messages
+ * pushed while the ring is full are dropped and counted rather than blocking a loop. */
+class Logger {
+	public:
+		enum Level { DEBUG, INFO, WARN, ERROR, SILENT };
+		enum Category {
+			SERVER,			/* Startup, shutdown and statistics */
+			CONNECTIONS,	/* Accepted, registered and dropped clients */
+			COMMANDS,		/* Channel and command activity */
+			IO,				/* Raw lines read and written, off by default */
+			CATEGORIES
+		};
+
+		/* Apply the configured level and categories and start the writer thread. Messages
+		 * logged before start or after stop are written synchronously. */
+		static void			start(const Config& config);
+		static void			stop();
+
+		/* Cheap check done before formatting anything */
+		static bool			isEnabled(Category category, Level level)	{ return level >= _thresholds[category]; }
+
+		static void			write(Category category, Level level, const std::string& message);
+
+	private:
+		/* Lowest level written for each category. Warnings and errors go through even
+		 * in disabled categories. */
+		static Level		_thresholds[CATEGORIES];
+
+		/* Private Member Functions */
+		static void*		_threadMain(void* unused);
+};
+
+#endif
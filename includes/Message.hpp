@@ -4,43 +4,66 @@
 #pragma once
 
 /* System Includes */
+#include <stdint.h>
 #include <string>
-#include <vector>
-#include <algorithm>
+
+/* Local Includes */
+#include "CommandTable.hpp"
+#include "StringView.hpp"
 
 /* Class Prototypes */
 class Command;
 class Client;
 
+/* A framed line split into its parts in one pass. Tags and parameters are kept as offsets
+ * into the line, which must outlive the message: it points into the client's input buffer. */
 class Message {
 	public:
+		/* RFC 1459: at most 15 parameters, the last one is the trailing */
+		enum { MAX_PARAMS = 15 };
+
 		/* Constructor & Destructor */
-		Message(Client* client, std::string raw);
+		Message(Client* client, const char* line, size_t length);
 		~Message() { }
 
 		/* Setters & Getters */
-		const	std::string&				getRaw() const			{ return _raw; }
-		const 	std::string&				getCommand() const		{ return _cmd; }
-		const	std::string&				getPrefix() const		{ return _prefix; }
-		const	std::string&				getTrailing() const 	{ return _trailing; }
-		const	std::vector<std::string>&	getMiddle() const		{ return _middle; }
-		const bool&							hasPrefix() const		{ return _hasPrefix; }
-		const bool&							hasMiddle() const		{ return _hasMiddle; }
-		const bool&							hasTrailing() const 	{ return _hasTrailing; }
+		StringView							getCommand() const		{ return _view(_cmd); }
+		CommandTable::Id					getCommandId() const	{ return _cmdId; }
+		StringView							getTags() const			{ return _view(_tags); }
+		StringView							getPrefix() const		{ return _view(_prefix); }
+		StringView							getTrailing() const 	{ return _view(_trailing); }
+		/* Empty view past the last middle parameter */
+		StringView							getMiddle(size_t index) const;
+		size_t								getMiddleCount() const	{ return _nbMiddle; }
+		/* Value of an IRCv3 tag, still escaped and empty if it has none. False when absent. */
+		bool								getTag(const char* key, StringView& value) const;
+		bool								hasTags() const			{ return _tags.length > 0; }
+		bool								hasPrefix() const		{ return _hasPrefix; }
+		bool								hasMiddle() const		{ return _nbMiddle > 0; }
+		bool								hasTrailing() const 	{ return _hasTrailing; }
 
 
 		/* Public Attributes */
 		Client*						_client;
 
 	private:
-		std::string 				_raw;			/* Raw input from recv() call */
-		std::string					_cmd;
-		std::string					_prefix;		/* Parameters before initial ':' (unlikely to ever occur) */
+		struct Token {
+			uint16_t	offset;
+			uint16_t	length;
+		};
+
+		const char*					_line;
+		Token						_tags;			/* After the leading '@', "key=value;key" */
+		Token						_cmd;			/* As received, any case */
+		CommandTable::Id			_cmdId;
+		Token						_prefix;		/* After the initial ':' (unlikely to ever occur) */
 		bool						_hasPrefix;
-		std::vector<std::string>	_middle;		/* Additional parameters for command */
-		bool						_hasMiddle;
-		std::string					_trailing;		/* Parameters after second ':' (any other colons after this are part of message string) */
+		Token						_middle[MAX_PARAMS - 1];	/* Additional parameters for command */
+		size_t						_nbMiddle;
+		Token						_trailing;		/* After the first ' :' (any other colons are part of it) */
 		bool						_hasTrailing;
+
+		StringView					_view(const Token& token) const	{ return StringView(_line + token.offset, token.length); }
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,43 @@
+#ifndef MUTEX_HPP
+# define MUTEX_HPP
+
+#pragma once
+
+/* System Includes */
+#include <pthread.h>
+
+/* Thin wrapper around a pthread mutex */
+class Mutex {
+	public:
+		/* Constructors & Destructor */
+		Mutex()		{ pthread_mutex_init(&_mutex, NULL); }
+		~Mutex()	{ pthread_mutex_destroy(&_mutex); }
+
+		/* Public Member Functions */
+		void				lock()		{ pthread_mutex_lock(&_mutex); }
+		void				unlock()	{ pthread_mutex_unlock(&_mutex); }
+
+	private:
+		pthread_mutex_t		_mutex;
+
+		/* Non-copyable */
+		Mutex(const Mutex&);
+		Mutex&				operator=(const Mutex&);
+};
+
+/* Holds a mutex for the lifetime of the object */
+class ScopedLock {
+	public:
+		/* Constructors & Destructor */
+		explicit ScopedLock(Mutex& mutex) : _mutex(mutex)	{ _mutex.lock(); }
+		~ScopedLock()										{ _mutex.unlock(); }
+
+	private:
+		Mutex&				_mutex;
+
+		/* Non-copyable */
+		ScopedLock(const ScopedLock&);
+		ScopedLock&			operator=(const ScopedLock&);
+};
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef NICKINDEX_HPP
+# define NICKINDEX_HPP
+
+#pragma once
+
+/* System Includes */
+#include <cstddef>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/* Class Prototypes */
+class Client;
+
+/* Clients by nickname, compared under RFC 1459 casemapping: "[]\^" are the upper case of
+ * "{}|~". Open addressing with linear probing, keyed by SipHash-1-3 with a random seed so
+ * that crafted nicknames cannot pile up in one probe sequence. The key is read from the
+ * client, so an entry must be erased before its nickname changes. */
+class NickIndex {
+	public:
+		/* Constructors */
+		NickIndex();
+
+		/* Public Member Functions */
+		Client*					find(const std::string& nick) const;
+		void					insert(Client* client);
+		void					erase(Client* client);
+		size_t					size() const		{ return _count; }
+
+		/* Compare two nicknames under RFC 1459 casemapping */
+		static bool				equals(const std::string& lhs, const std::string& rhs);
+
+	private:
+		struct Slot {
+			Client*				client;		/* NULL when free */
+			uint64_t			hash;
+		};
+
+		std::vector<Slot>		_slots;		/* Power of two, at most half full */
+		size_t					_count;
+		uint64_t				_seed[2];
+
+		/* Private Member Functions */
+		uint64_t				_hash(const std::string& nick) const;
+		size_t					_findSlot(const std::string& nick, uint64_t hash) const;
+		void					_grow();
+};
+
+#endif
@@ -0,0 +1,64 @@
+#ifndef PAYLOAD_HPP
+# define PAYLOAD_HPP
+
+#pragma once
+
+/* System Includes */
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <string>
+
+/* Immutable, reference counted message buffer. A broadcast is formatted once and every
+ * recipient's send queue holds a copy of the same Payload, which only bumps the count.
+ * The count is atomic since recipients may belong to other event loops. */
+class Payload {
+	public:
+		/* Constructors & Destructor */
+		Payload() : _buf(NULL) { }
+		explicit Payload(const std::string& data) : _buf(NULL) {
+			if (data.empty())
+				return;
+			/* Header and bytes share a single allocation */
+			_buf       = static_cast<Buffer*>(::operator new(sizeof(Buffer) + data.size()));
+			_buf->refs = 1;
+			_buf->size = data.size();
+			std::memcpy(_buf->data, data.data(), data.size());
+		}
+		Payload(const Payload& other) : _buf(other._buf) { _retain(); }
+		~Payload() { _release(); }
+
+		/* Operator Overloads */
+		Payload&	operator=(const Payload& other) {
+			if (_buf != other._buf) {
+				_release();
+				_buf = other._buf;
+				_retain();
+			}
+			return *this;
+		}
+
+		/* Setters & Getters */
+		const char*	data() const	{ return _buf ? _buf->data : ""; }
+		size_t		size() const	{ return _buf ? _buf->size : 0; }
+		bool		empty() const	{ return _buf == NULL; }
+
+	private:
+		struct Buffer {
+			int		refs;
+			size_t	size;
+			char	data[1];
+		};
+
+		Buffer*		_buf;
+
+		/* Private Member Functions */
+		void		_retain()	{ if (_buf) __sync_fetch_and_add(&_buf->refs, 1); }
+		void		_release()	{
+			if (_buf && __sync_sub_and_fetch(&_buf->refs, 1) == 0)
+				::operator delete(_buf);
+			_buf = NULL;
+		}
+};
+
+#endif
@@ -0,0 +1,51 @@
+#ifndef REACTOR_HPP
+# define REACTOR_HPP
+
+#pragma once
+
+/* System Includes */
+#include <string>
+#include <vector>
+
+/* Readiness notification backend used by the server loop. Sockets are registered
+ * with an opaque data pointer which is handed back untouched with every event.
+ * Backends able to do the I/O themselves may complete accepts and receives instead of
+ * reporting readiness, when asked to with ACCEPT or RECEIVE. */
+class Reactor {
+	public:
+		/* Event flags, translated from/to the backend specific ones */
+		enum e_events {
+			READABLE = 0x1,
+			WRITABLE = 0x2,
+			HANGUP   = 0x4,
+			ACCEPT   = 0x8,		/* Listener: hand over accepted sockets, result is the new fd */
+			RECEIVE  = 0x10		/* Socket: hand over received bytes, result is what recv() returned */
+		};
+
+		/* Backends without completions ignore ACCEPT and RECEIVE and report READABLE */
+		struct Event {
+			int			fd;
+			void*		data;
+			int			events;
+			int			result;		/* Negated errno on failure */
+			const char*	buffer;		/* RECEIVE data, valid until the next wait() */
+		};
+
+		/* Constructors & Destructor */
+		virtual ~Reactor() { }
+
+		/* Public Member Functions */
+		virtual const char*	getName() const = 0;
+		virtual void		add(int fd, int events, void* data) = 0;
+		virtual void		modify(int fd, int events, void* data) = 0;
+		virtual void		remove(int fd) = 0;
+		virtual int			wait(std::vector<Event>& ready, int timeout) = 0;
+
+		/* Build the requested backend, or the next best one available on this platform */
+		static Reactor*		create(const std::string& backend);
+
+	protected:
+		Reactor() { }
+};
+
+#endif
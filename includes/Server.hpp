@@ -18,14 +18,20 @@
 #include <vector>
 #include <map>
 #include <ctime>
+#include <csignal>
 #include <unistd.h>
 #include <netdb.h>
 #include <exception>
+#include <cstring>		// strerror
 
 /* Local Includes */
 #include "Client.hpp"
 #include "Channel.hpp"
+#include "Config.hpp"
+#include "EventLoop.hpp"
 #include "Message.hpp"
+#include "Mutex.hpp"
+#include "NickIndex.hpp"
 #include "defines.h"
 
 /* Class Prototypes */
@@ -33,7 +39,7 @@ class Command;
 
 class Server {
 	public:
-		Server(const std::string& servername, const int port, const std::string& password);
+		Server(const std::string& servername, const int port, const std::string& password, const Config& config);
 		~Server();
 		
 		/* Setters & Getters */
@@ -41,6 +47,8 @@ class Server {
 		const std::string&					getHostname(void) const 		{ return _hostname; }
 		const std::time_t&					getStartTime(void) const 		{ return _timeStart; }
 		const std::string&					getServername(void) const 		{ return _servername; }
+		Mutex&								getLock(void)					{ return _lock; }
+		const Config&						getConfig(void) const			{ return _config; }
 	
 		/*************************/
 		/*    Server Operation   */
@@ -50,17 +58,23 @@ class Server {
 		void								runServer();
 		void								stopServer();
 		void								stopServer(int signum);	/* Overload for signal() */
-		void								handleConnections();
-		void								handleMessages(Client* client);
+		void								wakeLoops();
+		bool								dumpTraces();
+		void								handleConnections(EventLoop* loop, int listenFd);
+		void								handleAccepted(EventLoop* loop, const std::vector<int>& sockets);
+		void								handleMessages(Client* client, int nbytes);
 		void								executeCommand(const Message & msg);
+		void								handleTimeout(Client* client, uint64_t now);
 		
 		/*************************/
 		/*   Client Management   */
 		/*************************/
-		bool								doesNickExist(const std::string nick) const;
+		bool								doesNickExist(const std::string& nick) const;
 		Client* 							getClientPtr(const std::string& client);
+		void								changeNickname(Client* client, const std::string& nick);
 		Channel*							getChannelPtr(const std::string& channel);
 		void								removeClient(Client* client);
+		void								dropClient(Client* client, const std::string& reason);
 
 		/************************/
 		/*  Channel Management  */
@@ -77,21 +91,29 @@ class Server {
 		std::string							_hostname;
 		std::string							_password;
 		const std::time_t					_timeStart;
+		const Config						_config;
 
 		/* Networking Data */
 		const int							_port;
 		struct sockaddr_in					_address;
-		int									_socket;
-		std::vector<pollfd>					_pfds;
+		std::vector<int>					_sockets;		/* Listening sockets, one per loop when sharded */
+		std::vector<EventLoop *>			_loops;
+		size_t								_nextLoop;		/* Round-robin loop assignment for new clients */
+		uint64_t							_lastTraceDump;	/* Clock::monotonic() of the last trace dump, 0 if none */
+		Mutex								_lock;			/* Guards all IRC data below while commands run, serializes the loops */
 		std::string							_ip;
 
 		/* IRC Server Data */
-		std::vector<Client *>				_clients;
+		std::vector<Client *>				_clients;		/* Indexed by socket fd, NULL for free slots */
+		size_t								_nbClients;
+		NickIndex							_nicks;			/* Clients with a nickname, by casemapped nickname */
 		std::map<std::string, Channel *>	_channels;
-		std::map<std::string, Command *>	_commands;
-};
+		Command *							_commands[CommandTable::COUNT];	/* NULL for UNKNOWN */
 
-/* Non-member functions */
-const std::string	getTimestamp();
+		/* Private Member Functions */
+		void								_openListener(bool reusePort);
+		void								_acceptFailed(EventLoop* loop, int error);
+		void								_registerClients(EventLoop* loop, const std::vector<std::pair<int, struct sockaddr_in> >& accepted);
+};
 
 #endif
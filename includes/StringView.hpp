@@ -0,0 +1,38 @@
+#ifndef STRINGVIEW_HPP
+# define STRINGVIEW_HPP
+
+#pragma once
+
+/* System Includes */
+#include <cstddef>
+#include <cstring>
+#include <string>
+
+/* Non-owning view over characters stored elsewhere, e.g. a client's input buffer. Only
+ * valid as long as the storage it points into is left untouched. */
+class StringView {
+	public:
+		/* Constructors */
+		StringView() : _data(""), _size(0) { }
+		StringView(const char* data, size_t size) : _data(data), _size(size) { }
+
+		/* Getters */
+		const char*			data() const					{ return _data; }
+		size_t				size() const					{ return _size; }
+		bool				empty() const					{ return _size == 0; }
+		char				operator[](size_t index) const	{ return _data[index]; }
+
+		/* Copy out, for values that outlive the view */
+		std::string			str() const						{ return std::string(_data, _size); }
+
+		bool				operator==(const char* rhs) const			{ return _size == std::strlen(rhs) && std::memcmp(_data, rhs, _size) == 0; }
+		bool				operator==(const std::string& rhs) const	{ return _size == rhs.size() && std::memcmp(_data, rhs.data(), _size) == 0; }
+		bool				operator!=(const char* rhs) const			{ return !(*this == rhs); }
+		bool				operator!=(const std::string& rhs) const	{ return !(*this == rhs); }
+
+	private:
+		const char*			_data;
+		size_t				_size;
+};
+
+#endif
@@ -0,0 +1,74 @@
+#ifndef TIMERWHEEL_HPP
+# define TIMERWHEEL_HPP
+
+#pragma once
+
+/* System Includes */
+#include <cstddef>
+#include <stdint.h>
+
+/* Intrusive timer node, embedded in the object it belongs to. The data pointer is
+ * handed back untouched when the timer fires. */
+class Timer {
+	public:
+		/* Constructors */
+		Timer() : data(NULL), _prev(NULL), _next(NULL), _expires(0) { }
+
+		void*		data;
+
+		/* Scheduled and not fired or cancelled yet */
+		bool		isPending() const { return _next != NULL; }
+
+	private:
+		friend class TimerWheel;
+
+		Timer*		_prev;
+		Timer*		_next;
+		uint64_t	_expires;	/* In wheel ticks */
+
+		/* Non-copyable */
+		Timer(const Timer&);
+		Timer&		operator=(const Timer&);
+};
+
+/* Hierarchical timer wheel on the monotonic clock. Scheduling and cancelling are O(1),
+ * and advancing only touches the slots that come due, cascading far away timers down
+ * a level as the wheel turns. Deadlines are in milliseconds and never fire early. */
+class TimerWheel {
+	public:
+		enum {
+			TICK_MS = 100,		/* Resolution */
+			BITS    = 6,
+			SLOTS   = 1 << BITS,
+			LEVELS  = 4			/* 64^4 ticks, about 194 days */
+		};
+
+		/* Constructors & Destructor */
+		TimerWheel();
+		~TimerWheel();
+
+		/* Public Member Functions */
+		void			schedule(Timer& timer, uint64_t when);
+		void			cancel(Timer& timer);
+		void			advance(uint64_t now);
+		Timer*			popExpired();
+		int				timeout(uint64_t now) const;
+
+	private:
+		Timer			_slots[LEVELS][SLOTS];	/* List heads */
+		Timer			_expired;				/* Fired timers waiting to be popped */
+		uint64_t		_current;				/* Last tick processed */
+		size_t			_count;					/* Timers linked in the wheel or _expired */
+
+		/* Private Member Functions */
+		void			_insert(Timer& timer);
+		void			_cascade(size_t level);
+		static void		_link(Timer& head, Timer& timer);
+		static void		_unlink(Timer& timer);
+
+		/* Non-copyable */
+		TimerWheel(const TimerWheel&);
+		TimerWheel&		operator=(const TimerWheel&);
+};
+
+#endif
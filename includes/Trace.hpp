@@ -0,0 +1,71 @@
+#ifndef TRACE_HPP
+# define TRACE_HPP
+
+#pragma once
+
+/* System Includes */
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/* Flight recorder: fixed-size ring of compact binary events, overwritten oldest first.
+ * Each event loop owns one and is its only writer, recording costs a clock read and a
+ * few stores. Dumps are turned into text by the tracedecode tool. */
+class Trace {
+	public:
+		enum Type {
+			ACCEPT = 1,		/* New connection */
+			READ,			/* value: bytes read */
+			DISPATCH,		/* value: command run time in ns, command: command id */
+			REPLY,			/* value: bytes queued */
+			DISCONNECT
+		};
+
+		/* On-disk layout, shared with the decoder */
+		struct Event {
+			uint64_t	time;		/* CLOCK_MONOTONIC, in ns */
+			uint32_t	value;
+			uint16_t	fd;			/* Truncated to 16 bits */
+			uint8_t		type;
+			uint8_t		command;	/* 0 for unknown commands */
+		};
+
+		/* Dump file: header, command names, then events oldest first */
+		struct Header {
+			char		magic[8];	/* "IRCTRACE" */
+			uint32_t	version;
+			uint32_t	loop;
+			uint32_t	nbCommands;
+			uint32_t	nbEvents;
+		};
+
+		enum { VERSION = 1, NAME_SIZE = 16 };
+
+		/* Constructors */
+		Trace();
+
+		static uint64_t				now();
+
+		/* Command ids, assigned once before the loops start */
+		static uint8_t				registerCommand(const std::string& name);
+
+		void						record(Type type, int fd, uint32_t value, uint8_t command = 0) {
+			Event& event  = _events[_next++ & (_events.size( ) - 1)];
+			event.time    = now( );
+			event.value   = value;
+			event.fd      = static_cast< uint16_t >(fd);
+			event.type    = type;
+			event.command = command;
+		}
+
+		/* Write the ring to a file, must be called by its owning loop */
+		bool						dump(const std::string& path, size_t loop) const;
+
+	private:
+		static std::vector<std::string>	_commandNames;	/* Indexed by command id */
+
+		std::vector<Event>			_events;
+		uint64_t					_next;		/* Total events recorded */
+};
+
+#endif
@@ -0,0 +1,25 @@
+#ifndef CAP_HPP
+#define CAP_HPP
+
+#pragma once
+
+/* System Includes */
+#include <string>
+
+/* Local Includes */
+#include "Command.hpp"
+
+class Cap : public Command {
+    public:
+        /* Constructors & Destructor */
+        Cap(Server* server);
+        ~Cap() { }
+
+        /* Public Member Functions */
+        void                execute(const Message& msg);
+
+    private:
+        bool                _request(Client* client, StringView list);
+};
+
+#endif
@@ -27,6 +27,9 @@ class Names : public Command
 		std::string 		_target;
 		bool 				_hasTarget;
 
+		/* Private Member Functions */
+		void				_replyNames(Client* client, Channel* channel, bool isMember);
+
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,26 @@
+#ifndef TRACEDUMP_HPP
+#define TRACEDUMP_HPP
+
+#pragma once
+
+/* System Includes */
+#include <string>
+
+/* Local Includes */
+#include "Command.hpp"
+
+class TraceDump : public Command
+{
+    public:
+        /* Constructors & Destructor */
+        TraceDump(Server* server);
+        ~TraceDump();
+
+        /* Public Member Functions */
+        void                execute(const Message& msg);
+
+    private:
+
+};
+
+#endif
@@ -4,13 +4,34 @@
 #pragma once
 
 extern int	g_status;
+extern int	g_traceDump;	/* Set by SIGUSR1 */
+
+/* MacOS has no MSG_NOSIGNAL, SIGPIPE is disabled with SO_NOSIGPIPE on each socket instead */
+#ifndef MSG_NOSIGNAL
+# define MSG_NOSIGNAL 0
+#endif
 
 
 /* General server settings */
-#define MAX_BUFFER_SIZE 512		/* Maximum read size from recv() in bytes */
+#define INPUT_BUFFER_SIZE 16384	/* Per-client input buffer, holds pipelined lines between reads */
+#define MAX_LINE_LENGTH 512		/* RFC 1459 limit, line ending included */
+#define NICK_MAX_LENGTH 9		/* RFC 1459 limit */
+#define MAX_TAGS_LENGTH 8191	/* IRCv3 message tags, leading '@' and trailing space included */
+#define READ_BUDGET     16384	/* Maximum bytes read from one client per loop iteration */
+#define RECV_BUFFER_SIZE 4096	/* io_uring provided receive buffers, at most one per client and iteration */
+#define MAX_IOVECS      64		/* Queued replies gathered in a single sendmsg() */
 #define MAX_CHANNELS    100		/* Maximum number of channels that can exist on server */
 #define PING_INTERVAL   180		/* Interval after which to send a ping to client since their last activity */
-#define MAX_CONNECTIONS 10
+#define PING_TIMEOUT    120		/* Time left to a pinged client to show activity before being dropped */
+#define REG_TIMEOUT     60		/* Time left to a new connection to complete registration */
+#define MAX_CONNECTIONS 1024	/* Listen backlog, capped by the kernel (somaxconn) */
+#define ACCEPT_BACKOFF  100		/* Milliseconds the listener is left alone once out of file descriptors */
+#define ACCEPT_BATCH    64		/* Connections registered per loop iteration, the others wait for the next ones */
+#define ACCEPT_QUEUE    256		/* Connections accepted by io_uring and waiting to be registered, before it stops */
+#define LOG_RING_SIZE   1024	/* Log messages waiting for the writer thread, power of two */
+#define LOG_LINE_MAX    1024	/* Longer log messages are truncated */
+#define TRACE_RING_SIZE 65536	/* Flight recorder events kept per event loop, power of two */
+#define TRACE_DUMP_INTERVAL 10	/* Minimum seconds between two flight recorder dumps */
 
 /* Global Modes */
 typedef enum e_globalModes {
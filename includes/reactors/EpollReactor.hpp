@@ -0,0 +1,40 @@
+#ifndef EPOLLREACTOR_HPP
+# define EPOLLREACTOR_HPP
+
+#pragma once
+
+#ifdef __linux__
+
+/* System Includes */
+#include <sys/epoll.h>
+#include <cstddef>
+#include <vector>
+
+/* Local Includes */
+#include "Reactor.hpp"
+
+/* Linux epoll backend: the interest list lives in the kernel, so a wakeup only costs
+ * as much as the number of ready sockets */
+class EpollReactor : public Reactor {
+	public:
+		/* Constructors & Destructor */
+		EpollReactor();
+		~EpollReactor();
+
+		/* Public Member Functions */
+		const char*					getName() const { return ("epoll"); }
+		void						add(int fd, int events, void* data);
+		void						modify(int fd, int events, void* data);
+		void						remove(int fd);
+		int							wait(std::vector<Event>& ready, int timeout);
+
+	private:
+		int							_epfd;
+		size_t						_nbRegistered;
+		std::vector<void*>			_data;		/* Indexed by fd */
+		std::vector<epoll_event>	_events;	/* Output buffer for epoll_wait() */
+};
+
+#endif
+
+#endif
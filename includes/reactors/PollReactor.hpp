@@ -0,0 +1,37 @@
+#ifndef POLLREACTOR_HPP
+# define POLLREACTOR_HPP
+
+#pragma once
+
+/* System Includes */
+#include <poll.h>
+#include <cstddef>
+#include <vector>
+
+/* Local Includes */
+#include "Reactor.hpp"
+
+/* Portable poll() backend, used when no better mechanism is available */
+class PollReactor : public Reactor {
+	public:
+		/* Constructors & Destructor */
+		PollReactor() { }
+		~PollReactor() { }
+
+		/* Public Member Functions */
+		const char*			getName() const { return ("poll"); }
+		void				add(int fd, int events, void* data);
+		void				modify(int fd, int events, void* data);
+		void				remove(int fd);
+		int					wait(std::vector<Event>& ready, int timeout);
+
+	private:
+		std::vector<pollfd>	_pfds;		/* Dense, removal moves the last entry into the hole */
+		std::vector<void*>	_data;		/* Parallel to _pfds */
+		std::vector<int>	_index;		/* Position in _pfds, indexed by fd, -1 if unregistered */
+
+		/* Private Member Functions */
+		int					_find(int fd) const;
+};
+
+#endif
@@ -0,0 +1,109 @@
+#ifndef URINGREACTOR_HPP
+# define URINGREACTOR_HPP
+
+#pragma once
+
+/* Multishot accept and provided buffer rings came with the Linux 5.19 headers */
+#ifdef __linux__
+# if defined(__has_include)
+#  if __has_include(<linux/io_uring.h>)
+#   include <linux/io_uring.h>
+#   ifdef IORING_ACCEPT_MULTISHOT
+#    define HAS_IO_URING 1
+#   endif
+#  endif
+# endif
+#endif
+
+#ifdef HAS_IO_URING
+
+/* System Includes */
+#include <stdint.h>
+#include <cstddef>
+#include <vector>
+
+/* Local Includes */
+#include "Reactor.hpp"
+
+/* Linux io_uring backend. Listeners registered with ACCEPT get a multishot accept, and
+ * sockets registered with RECEIVE a receive drawing from a ring of provided buffers, so
+ * that connections and input arrive as completions with no further system call. Other
+ * interests are watched with one-shot poll requests which are re-armed after each
+ * completion, so readiness stays level-triggered like poll() and epoll. Every request
+ * queued during a loop turn is submitted together with the wait itself, in a single
+ * io_uring_enter() call. Kernels older than 5.19 get polls for everything. */
+class UringReactor : public Reactor {
+	public:
+		/* Constructors & Destructor */
+		UringReactor();
+		~UringReactor();
+
+		/* Public Member Functions */
+		const char*					getName() const { return ("io_uring"); }
+		void						add(int fd, int events, void* data);
+		void						modify(int fd, int events, void* data);
+		void						remove(int fd);
+		int							wait(std::vector<Event>& ready, int timeout);
+
+	private:
+		/* Per-fd registration state */
+		struct Registration {
+			void*		data;
+			int			events;
+			uint32_t	generation;		/* Bumped on every re-registration, stale completions are dropped */
+			uint32_t	pollGeneration;	/* ...and on every poll mask change, for poll requests */
+			bool		registered;
+			bool		armed;			/* A poll request is in flight in the kernel */
+			bool		pending;		/* An accept or receive request is in flight */
+		};
+
+		int							_ringfd;
+
+		/* Submission queue */
+		void*						_sqRing;
+		size_t						_sqRingSize;
+		unsigned*					_sqHead;
+		unsigned*					_sqTail;
+		unsigned					_sqMask;
+		unsigned					_sqEntries;
+		unsigned*					_sqArray;
+		io_uring_sqe*				_sqes;
+		size_t						_sqesSize;
+		unsigned					_sqPending;		/* Queued but not yet submitted */
+
+		/* Completion queue */
+		void*						_cqRing;
+		size_t						_cqRingSize;
+		unsigned*					_cqHead;
+		unsigned*					_cqTail;
+		unsigned					_cqMask;
+		io_uring_cqe*				_cqes;
+
+		/* Provided receive buffers */
+		io_uring_buf*				_bufRing;		/* Shared with the kernel, NULL if unsupported */
+		size_t						_bufRingSize;
+		char*						_buffers;
+		uint16_t					_bufTail;
+		std::vector<uint16_t>		_lent;			/* Buffers to give back to the kernel */
+
+		bool						_multishotAccept;
+		std::vector<Registration>	_registrations;	/* Indexed by fd */
+		std::vector<int>			_toArm;			/* Fds waiting for a request */
+
+		/* Private Member Functions */
+		void						_release();
+		void						_setupBuffers();
+		void						_recycleBuffers();
+		int							_completionFor(int events) const;
+		uint32_t					_pollMask(int events) const;
+		io_uring_sqe*				_getSqe();
+		int							_submit(unsigned minComplete, int timeout);
+		void						_queuePoll(int fd);
+		void						_queueAccept(int fd);
+		void						_queueRecv(int fd);
+		void						_queueCancel(uint64_t userData);
+};
+
+#endif
+
+#endif
@@ -77,12 +77,16 @@
 	":" + (nick) + "!" + (user) + "@" + (ip) + " QUIT :Connection closed" + "\r\n"
 #define CMD_INVITE(prefix, targetnick, channel)                                          \
 	":" + (prefix) + " INVITE " + (targetnick) + " " + (channel) + "\r\n"
+#define CMD_CAP(host, client, subcommand, caps)                                          \
+	":" + (host) + " CAP " + (client) + " " + (subcommand) + " :" + (caps) + "\r\n"
 #define CMD_MODE(prefix, channel, modes)                                                 \
 	":" + (prefix) + " MODE " + (channel) + " :" + (modes) + "\r\n"
 
 /* Error Messages */
 #define ERR_SHUTDOWN(user, address)                                                      \
 	"ERROR :Closing link: (" + (user) + "@" + (address) + ") [Server shutting down]\r\n"
+#define ERR_CLOSINGLINK(user, address, reason)                                           \
+	"ERROR :Closing link: (" + (user) + "@" + (address) + ") [" + (reason) + "]\r\n"
 
 #define ERR_NOSUCHNICK(host, client, target)                                             \
 	":" + (host) + " 401 " + (client) + " " + (target) + " :No such nick" + "\r\n"
@@ -95,6 +99,10 @@
 	":" + (host) + " 411 " + (client) + " :No recipient given (" + (cmd) + ")" + "\r\n"
 #define ERR_NOTEXTTOSEND(host, client, target)                                           \
 	":" + (host) + " 412 " + (client) + " " + (target) + " :No text to send" + "\r\n"
+#define ERR_INVALIDCAPCMD(host, client, subcommand)                                      \
+	":" + (host) + " 410 " + (client) + " " + (subcommand) + " :Invalid CAP subcommand" + "\r\n"
+#define ERR_INPUTTOOLONG(host, client)                                                   \
+	":" + (host) + " 417 " + (client) + " :Input line was too long" + "\r\n"
 #define ERR_UNKNOWNCOMMAND(host, client, target)                                         \
 	":" + (host) + " 421 " + (client) + " " + (target) + " :Unknown command" + "\r\n"
 #define ERR_NONICKNAMEGIVEN(host) ":" + (host) + " 431 : No nickname given" + "\r\n"
@@ -129,6 +137,8 @@
 	  + "\r\n"
 #define ERR_BADCHANMASK(host, client, target)                                            \
 	":" + (host) + " 476 " + (client) + " " + (target) + " :Bad Channel Mask" + "\r\n"
+#define ERR_NOPRIVILEGES(host, client)                                                   \
+	":" + (host) + " 481 " + (client) + " :Permission Denied- You're not an IRC operator" + "\r\n"
 #define ERR_CHANOPRIVSNEEDED(host, client, target, modeMessage)                          \
 	":" + (host) + " 482 " + (client) + " " + (target)                                   \
 	  + " :You must be channel op or higher " + (modeMessage) + "\r\n"
@@ -0,0 +1,51 @@
+/* Local Includes */
+#include "Broadcast.hpp"
+#include "Client.hpp"
+#include "Clock.hpp"
+
+/* System Includes */
+#include <cstdio>
+#include <ctime>
+#include <stdint.h>
+
+/* Message ids are the server start time followed by a process-wide sequence number */
+static const std::time_t	s_boot = std::time(NULL);
+static uint64_t				s_nextId = 0;
+
+Broadcast::Broadcast(const std::string& line) : _line(line) { }
+
+const Payload& Broadcast::to(const Client* client) {
+	int			caps = client->getCapabilities() & (Client::CAP_MESSAGE_TAGS | Client::CAP_SERVER_TIME);
+	Payload&	payload = _variants[caps];
+
+	if (!payload.empty())
+		return payload;
+	if (!caps)
+		return payload = Payload(_line);
+
+	if (_time.empty())
+		_formatTags();
+	std::string tagged = "@";
+	if (caps & Client::CAP_SERVER_TIME)
+		tagged += _time;
+	if (caps & Client::CAP_MESSAGE_TAGS)
+		tagged += ((caps & Client::CAP_SERVER_TIME) ? ";" : "") + _msgid;
+	tagged += " ";
+	return payload = Payload(tagged + _line);
+}
+
+void Broadcast::_formatTags() {
+	uint64_t	now = Clock::wallMs();
+	std::time_t	seconds = now / 1000;
+	struct tm	utc;
+	char		buf[64];
+
+	gmtime_r(&seconds, &utc);
+	std::snprintf(buf, sizeof(buf), "time=%04d-%02d-%02dT%02d:%02d:%02d.%03uZ", utc.tm_year + 1900,
+	              utc.tm_mon + 1, utc.tm_mday, utc.tm_hour, utc.tm_min, utc.tm_sec,
+	              static_cast<unsigned>(now % 1000));
+	_time = buf;
+	std::snprintf(buf, sizeof(buf), "msgid=%lx-%llx", static_cast<unsigned long>(s_boot),
+	              static_cast<unsigned long long>(__sync_add_and_fetch(&s_nextId, 1)));
+	_msgid = buf;
+}
@@ -1,15 +1,24 @@
 /* Local Includes */
 #include "Channel.hpp"
+#include "Broadcast.hpp"
 #include "Client.hpp"
+#include "Clock.hpp"
+#include "Logger.hpp"
 #include "defines.h"
+#include "replies.h"
+
+/* System Includes */
+#include <algorithm>
+#include <stdint.h>
 
 class Client;
 
 Channel::Channel(const std::string& name, Client* owner)
-  : _name(name), _owner(owner), _timeStart(std::time(nullptr)) {
+  : _name(name), _owner(owner), _timeStart(Clock::wall( )), _nbVisible(0), _nbOperators(0) {
 	/* Set default channel modes */
 	_modes = 0;
 	setModes(TOPIC_SET_OP | NO_MSG_IN);
+	invalidateNames( );
 }
 
 /*******************************/
@@ -27,42 +36,55 @@ void Channel::setModes(char modes, bool removeMode) {
 
 /* Set member mode flags for a specified client */
 void Channel::setMemberModes(Client* client, char modes, bool removeMode) {
-	MemberMap::iterator it = _members.find(client);
+	Member* member = _findMember(client);
+	Mode*   current;
+	bool    wasOp  = member && (member->modes & C_OP);
 
 	/* Check if user is a member of channel*/
-	if (it == _members.end( )) {
+	if (member)
+		current = &member->modes;
+	else {
 		/* Check if a user is a member of notMembers */
-		it = _notMembers.find(client);
+		MemberMap::iterator it = _notMembers.find(client);
 
 		/* If user is not known to the Channel, add them */
 		if (it == _notMembers.end( )) {
 			if (removeMode)
 				return;
-			_notMembers.insert(std::pair< Client*, int >(client, modes));
-			it = _notMembers.find(client);
+			it = _notMembers.insert(std::pair< Client*, int >(client, modes)).first;
+			client->addFlaggedChannel(this);
 		}
+		current = &it->second;
 	}
 
 	/* If setmode is to remove flag*/
 	if (removeMode) {
 		if (modes & PASS_REQ)
 			_password.clear( );
-		it->second &= ~(modes);
-		return;
+		*current &= ~(modes);
+	}
+	else
+		*current |= modes;
+
+	/* Keep the operator count and the names in step with the members' modes */
+	if (member) {
+		if (wasOp != bool(member->modes & C_OP))
+			wasOp ? --_nbOperators : ++_nbOperators;
+		invalidateNames( );
 	}
-	it->second |= modes;
 }
 
 /* Check member mode flags for specified client */
 bool Channel::checkMemberModes(Client* client, char modes) const {
-	MemberMap::const_iterator it = _members.find(client);
+	const Member* member = _findMember(client);
+
+	if (member)
+		return (member->modes & modes);
 
 	/* Return without doing anything if user not found in list */
-	if (it == _members.end( )) {
-		it = _notMembers.find(client);
-		if (it == _notMembers.end( ))
-			return (false);
-	}
+	MemberMap::const_iterator it = _notMembers.find(client);
+	if (it == _notMembers.end( ))
+		return (false);
 	return (it->second & modes);
 }
 
@@ -82,10 +104,9 @@ std::vector< std::string > Channel::getBanList(void) const {
 	std::vector< std::string > banList;
 	MemberMap::const_iterator  ite;
 
-	ite = _members.end( );
-	for (MemberMap::const_iterator it = _members.begin( ); it != ite; ++it)
-		if (it->second & BAN)
-			banList.push_back(it->first->getPrefix( ));
+	for (size_t i = 0; i < _members.size( ); ++i)
+		if (_members[i].modes & BAN)
+			banList.push_back(_members[i].client->getPrefix( ));
 
 	ite = _notMembers.end( );
 	for (MemberMap::const_iterator it = _notMembers.begin( ); it != ite; ++it)
@@ -101,7 +122,7 @@ std::vector< std::string > Channel::getBanList(void) const {
 
 /* Check if specified client is a member of channel */
 bool Channel::isMember(Client* client) {
-	return (_members.find(client) != _members.end( ));
+	return (_findMember(client) != NULL);
 }
 
 /* Add a new member to channel */
@@ -109,26 +130,27 @@ void Channel::addMember(Client* client, const std::string& reply, int modes) {
 	/* Check if user is on notMembers list and move them */
 	MemberMap::iterator it = _notMembers.find(client);
 	if (it != _notMembers.end( )) {
-		_members.insert(std::pair< Client*, int >(client, modes | it->second));
+		_insertMember(client, modes | it->second);
 		_notMembers.erase(it);
+		client->removeFlaggedChannel(this);
 	}
 	/* Add member and set default member modes */
 	else {
-		_members.insert(std::pair< Client*, int >(client, modes));
+		_insertMember(client, modes);
 	}
+	client->addChannel(this);
 	sendToAll(reply);
-	std::cout << getTimestamp( ) << GREEN "New member: " CLEAR << client->getNickname( )
-	          << GREEN " joined channel: " CLEAR << this->getName( ) << std::endl;
+	LOG(COMMANDS, INFO, GREEN "New member: " CLEAR << client->getNickname( )
+	                    << GREEN " joined channel: " CLEAR << this->getName( ));
 }
 
 /* Remove a member from channel */
 void	Channel::removeMember(Client* client) {
 	bool				wasOpe = false;
-	MemberMap::iterator it = _members.find(client);
-
+	Member*				member = _findMember(client);
 
 	/* Return is member not found in channel */
-	if (it == _members.end( ))
+	if (!member)
 		return;
 
 	/* Check if member was owner */
@@ -136,95 +158,215 @@ void	Channel::removeMember(Client* client) {
 		wasOpe = true;
 
 	/* If member is banned keep track of them*/
-	if (checkMemberModes(client, BAN))
-		_notMembers[it->first] = it->second;
+	if (checkMemberModes(client, BAN)) {
+		_notMembers[client] = member->modes;
+		client->addFlaggedChannel(this);
+	}
 
 	/* Erase member from channel */
-	_members.erase(it);
+	_eraseMember(client);
+	client->removeChannel(this);
 
 	/* If member was operator, make sure there is at least one operator in channel */
 	if (!_members.empty( ) && wasOpe)
 		ensureOperator( );
 }
 
+/* Drop the bans and invites of a client leaving the server, its pointer is about to go stale */
+void Channel::forgetClient(Client* client) {
+	_notMembers.erase(client);
+	client->removeFlaggedChannel(this);
+}
+
+/* Detach the channel from the clients still referring to it, before it is deleted */
+void Channel::closeChannel( ) {
+	for (size_t i = 0; i < _members.size( ); ++i)
+		_members[i].client->removeChannel(this);
+	for (MemberMap::iterator it = _notMembers.begin( ); it != _notMembers.end( ); ++it)
+		it->first->removeFlaggedChannel(this);
+	_members.clear( );
+	_memberIndex.clear( );
+	_notMembers.clear( );
+	_nbVisible   = 0;
+	_nbOperators = 0;
+	invalidateNames( );
+}
+
 /*
  * @param isMember: Invisible (mode +i) users will only be displayed to member requesting users
  */
 std::string Channel::getMemberList(bool isMember) {
-	MemberMap::iterator it = _members.begin( );
-	std::string         list;
+	std::string list;
 
 	// fixme either do vector+sort to have owner+ops at the top of list or sort them that
 	// way while adding them
 	/*loops through the MemberMap and build a space-separated list of every nickname
 	 * on this channel, adding a '@' in front of the nick of owner/ops */
-	for (; it != _members.end( ); ++it) {
-		if (!isMember && it->first->checkGlobalModes(INVIS)){
+	for (size_t i = 0; i < _members.size( ); ++i) {
+		if (!isMember && _members[i].client->checkGlobalModes(INVIS)){
 			continue;
 		}
-		if (checkMemberModes(it->first,C_OP | OWNER))
-			list.append("@" + it->first->getNickname( ));
+		if (_members[i].modes & (C_OP | OWNER))
+			list.append("@" + _members[i].client->getNickname( ));
 		else
-			list.append(it->first->getNickname( ));
+			list.append(_members[i].client->getNickname( ));
 		list.append(" ");
 	}
 	return list;
 }
 
-std::vector< std::string > Channel::getMemberVector(void) {
-	MemberMap::iterator        it = _members.begin( );
-	std::vector< std::string > list;
+/*
+ * Nicknames for RPL_NAMREPLY, split so that each reply fits in MAX_LINE_LENGTH whatever the
+ * recipient's nickname. Built once and reused until membership, modes or nicknames change.
+ * @param isMember: Invisible (mode +i) users will only be displayed to member requesting users
+ */
+const std::vector< std::string >& Channel::getNameReplies(const std::string& host, bool isMember) {
+	std::vector< std::string >& lines = _names[isMember];
 
-	/* loops through the MemberMap and builds a space-separated list of every nickname
-	 * on this channel, adding a '@' in front of the nick of owner/ops */
-	for (; it != _members.end( ); ++it) {
-		if (it->second == C_OP || it->second == OWNER)
-			list.push_back("@" + it->first->getNickname( ));
-		else if (!it->first->checkGlobalModes(INVIS))
-			list.push_back(it->first->getNickname( ));
-	}
-	return list;
-}
+	if (_namesValid[isMember])
+		return lines;
+
+	size_t prefix = RPL_NAMREPLY(host, std::string(NICK_MAX_LENGTH, ' '), _name, "").size( );
+	size_t budget = MAX_LINE_LENGTH - prefix;
 
-size_t Channel::getNbVisibleUsers(void) const {
-	MemberMap::const_iterator it             = _members.begin( );
-	size_t                    nbVisibleUsers = 0;
+	/* An empty channel still gets one reply */
+	lines.assign(1, std::string( ));
+	for (size_t i = 0; i < _members.size( ); ++i) {
+		if (!isMember && _members[i].client->checkGlobalModes(INVIS))
+			continue;
+
+		const std::string& nick = _members[i].client->getNickname( );
+		bool               isOp = _members[i].modes & (C_OP | OWNER);
 
-	/* Loops through the MemberMap and counts the amount of visible users */
-	for (; it != _members.end( ); ++it) {
-		if (!it->first->checkGlobalModes(INVIS))
-			++nbVisibleUsers;
+		if (!lines.back( ).empty( ) && lines.back( ).size( ) + 1 + isOp + nick.size( ) > budget)
+			lines.push_back(std::string( ));
+		if (!lines.back( ).empty( ))
+			lines.back( ) += ' ';
+		if (isOp)
+			lines.back( ) += '@';
+		lines.back( ) += nick;
 	}
-	return nbVisibleUsers;
+	_namesValid[isMember] = true;
+	return lines;
+}
+
+/* Called by a member toggling user mode +i */
+void Channel::updateVisibility(bool visible) {
+	visible ? ++_nbVisible : --_nbVisible;
+	invalidateNames( );
 }
 
 /* Make sure there is at least one OP in channel*/
 void Channel::ensureOperator(void) {
-	MemberMap::iterator it = _members.begin( );
-
-	/* Check if there is another OP in channel */
-	for (; it != _members.end( ); ++it) {
-		if (checkMemberModes(it->first, C_OP))
-			return;
-	}
+	if (_nbOperators || _members.empty( ))
+		return;
 	/* If no OP found, assign OP for first member in channel */
-	it = _members.begin( );
-	setMemberModes(it->first, C_OP);
+	_members[0].modes |= C_OP;
+	++_nbOperators;
+	invalidateNames( );
 }
 
 /* Send message to all members of channel other than client */
 void Channel::sendToOthers(const std::string& reply, Client* sender) {
-	MemberMap::iterator it = _members.begin( );
+	Broadcast broadcast(reply); /* Formatted once, shared by every member */
 
-	for (; it != _members.end( ); ++it) {
-		if (it->first != sender)
-			it->first->reply(reply);
+	for (size_t i = 0; i < _members.size( ); ++i) {
+		if (_members[i].client != sender)
+			_members[i].client->reply(broadcast.to(_members[i].client));
 	}
 }
 
 /* Send reply to all members of channel */
 void Channel::sendToAll(const std::string& reply) {
-	MemberMap::iterator it = _members.begin( );
-	for (; it != _members.end( ); ++it)
-		it->first->reply(reply);
+	Broadcast broadcast(reply); /* Formatted once, shared by every member */
+
+	for (size_t i = 0; i < _members.size( ); ++i)
+		_members[i].client->reply(broadcast.to(_members[i].client));
+}
+
+/***********************************/
+/*          Member Storage         */
+/***********************************/
+
+/* Fibonacci hashing, the low bits of an address are always zero */
+static size_t hashMember(const Client* client, size_t mask) {
+	return ((reinterpret_cast< uintptr_t >(client) * 0x9E3779B97F4A7C15ULL) >> 32) & mask;
+}
+
+/* Slot holding the client's position, or the free slot ending its probe sequence */
+size_t Channel::_findSlot(Client* client) const {
+	size_t mask = _memberIndex.size( ) - 1;
+	size_t slot = hashMember(client, mask);
+
+	while (_memberIndex[slot] && _members[_memberIndex[slot] - 1].client != client)
+		slot = (slot + 1) & mask;
+	return slot;
+}
+
+Channel::Member* Channel::_findMember(Client* client) {
+	if (_members.empty( ))
+		return NULL;
+	uint32_t position = _memberIndex[_findSlot(client)];
+	return position ? &_members[position - 1] : NULL;
+}
+
+const Channel::Member* Channel::_findMember(Client* client) const {
+	if (_members.empty( ))
+		return NULL;
+	uint32_t position = _memberIndex[_findSlot(client)];
+	return position ? &_members[position - 1] : NULL;
+}
+
+/* The index stays at most half full */
+void Channel::_insertMember(Client* client, Mode modes) {
+	if ((_members.size( ) + 1) * 2 > _memberIndex.size( ))
+		_growIndex( );
+
+	Member member = {client, modes};
+	_members.push_back(member);
+	_memberIndex[_findSlot(client)] = _members.size( );
+
+	_nbVisible += !client->checkGlobalModes(INVIS);
+	_nbOperators += bool(modes & C_OP);
+	invalidateNames( );
+}
+
+/* Backward shift deletion in the index, then swap-remove from the dense array. The index
+ * entry must go first: until then it still leads probes for the client at its position. */
+void Channel::_eraseMember(Client* client) {
+	size_t   mask     = _memberIndex.size( ) - 1;
+	size_t   hole     = _findSlot(client);
+	uint32_t position = _memberIndex[hole];
+
+	if (!position)
+		return;
+
+	_nbVisible -= !client->checkGlobalModes(INVIS);
+	_nbOperators -= bool(_members[position - 1].modes & C_OP);
+	invalidateNames( );
+
+	for (size_t next = (hole + 1) & mask; _memberIndex[next]; next = (next + 1) & mask) {
+		Client* shifted = _members[_memberIndex[next] - 1].client;
+		size_t  home    = hashMember(shifted, mask);
+		/* Move the entry if the hole lies between its home slot and where it sits */
+		if (((next - home) & mask) >= ((next - hole) & mask)) {
+			_memberIndex[hole] = _memberIndex[next];
+			hole               = next;
+		}
+	}
+	_memberIndex[hole] = 0;
+
+	/* The last member takes the place of the removed one, its entry is repointed before the
+	 * array changes so that the probe still finds it */
+	if (position != _members.size( )) {
+		_memberIndex[_findSlot(_members.back( ).client)] = position;
+		_members[position - 1]                            = _members.back( );
+	}
+	_members.pop_back( );
+}
+
+void Channel::_growIndex(void) {
+	_memberIndex.assign(std::max< size_t >(8, _memberIndex.size( ) * 2), 0);
+	for (size_t i = 0; i < _members.size( ); ++i)
+		_memberIndex[_findSlot(_members[i].client)] = i + 1;
 }
\ No newline at end of file
@@ -1,16 +1,64 @@
 #include "Client.hpp"
+#include "Clock.hpp"
+#include "EventLoop.hpp"
+#include "Logger.hpp"
 #include "Server.hpp"
 #include "defines.h"
+#include "replies.h"
+
+/* System Includes */
+#include <algorithm>
+#include <cstring>
+#include <sys/uio.h>
+
+/* Raw protocol data indented under the log message tracing it, without line endings */
+static std::string indent(const char* data, size_t size) {
+	std::string out;
+	size_t      start = 0;
+
+	while (start < size) {
+		size_t end = start;
+		while (end < size && data[end] != '\n')
+			++end;
+		size_t len = end - start;
+		if (len && data[start + len - 1] == '\r')
+			--len;
+		out += "\n\t\t\t\t";
+		out.append(data + start, len);
+		start = end + 1;
+	}
+	return out;
+}
 
 /* Constructors & Destructor */
-Client::Client(int socket) : _socket(socket), _timeConnect(std::time(nullptr)) {
+Client::Client(int socket)
+  : _socket(socket), _timeConnect(Clock::wall( )), _timeLastActivity(_timeConnect),
+    _msLastActivity(Clock::monotonic( )), _loop(nullptr) {
+	_input           = new char[INPUT_BUFFER_SIZE];
+	_inputStart      = 0;
+	_inputScan       = 0;
+	_inputEnd        = 0;
+	_isDiscarding    = false;
 	_isPassValidated = false;
+	_capabilities    = 0;
+	_isNegotiating   = false;
 	_isRegistered    = false;
+	_isClosing       = false;
+	_isPollingOut    = false;
+	_sendOffset      = 0;
+	_sendQueueSize   = 0;
+	_isSendQExceeded = false;
+	_sendQLimits[0]  = 0;
+	_sendQLimits[1]  = 0;
 	_globalModes     = 0;
 	_wasPinged       = false;
+	_timer.data      = this;
 }
 
-Client::~Client( ) { shutdown(_socket, SHUT_RDWR); }
+Client::~Client( ) {
+	close(_socket);
+	delete[] _input;
+}
 
 /************************/
 /*    Mode Management   */
@@ -18,6 +66,11 @@ Client::~Client( ) { shutdown(_socket, SHUT_RDWR); }
 
 /* Set global server mode flags */
 void Client::setGlobalModes(const char &modes, bool removeMode) {
+	/* Channels count their visible members, tell them when that changes */
+	if ((modes & INVIS) && removeMode == checkGlobalModes(INVIS))
+		for (size_t i = 0; i < _channels.size( ); ++i)
+			_channels[i]->updateVisibility(removeMode);
+
 	/* removeMode toggles whether the provided mode(s) need(s) to be added or removed */
 	if (removeMode) {
 		_globalModes &= ~(modes);
@@ -38,67 +91,259 @@ std::string Client::getGlobalModes(void) {
 	return globalModes;
 }
 
+/*****************************/
+/*     Channel Membership    */
+/*****************************/
+
+/* Order does not matter, the last entry takes the place of the removed one */
+static void eraseChannel(std::vector< Channel* >& channels, Channel* channel) {
+	std::vector< Channel* >::iterator it = std::find(channels.begin( ), channels.end( ), channel);
+
+	if (it == channels.end( ))
+		return;
+	*it = channels.back( );
+	channels.pop_back( );
+}
+
+void Client::removeChannel(Channel* channel) { eraseChannel(_channels, channel); }
+
+void Client::removeFlaggedChannel(Channel* channel) { eraseChannel(_flaggedChannels, channel); }
+
 /*****************************/
 /*      I/O Management       */
 /*****************************/
 
-/* Read data from socket */
+/* Drain the socket into the input buffer until it would block, the read budget is spent or
+ * the buffer is full. Returns the number of bytes read, 0 if the client disconnected, -1 on
+ * error and READ_AGAIN if there was nothing to read, as after a spurious wakeup. Data left over
+ * is picked up on the next loop iteration. */
 int Client::read(void) {
-	char        buf[MAX_BUFFER_SIZE];
-	int         nbytes;
-	std::string input;
+	ssize_t nbytes;
+	int     total = 0;
 
-	/* Read from client socket */
-	nbytes = recv(_socket, buf, MAX_BUFFER_SIZE, 0);
-	/* If return is 0 or less, client has disconnected */
-	if (nbytes <= 0)
-		return (nbytes);
-	buf[nbytes] = '\0';
-	input       = buf;
-	if (nbytes == MAX_BUFFER_SIZE)
-		input = input.replace(510, 2, "\r\n");
-	_inputBuffer.append(input);
-	_timeLastActivity = std::time(nullptr);
-	/* Print received messages from client */
-	std::cout << getTimestamp( ) << BLUE "Raw input received from client on socket #"
-	          << _socket << ":" << CLEAR << std::endl;
-
-	/* Print input to terminal in proper format */
-	std::string tmp = _inputBuffer;
-	size_t      pos = 0;
-	while ((pos = tmp.find("\n")) != std::string::npos) {
-		std::cout << "\t\t\t\t" << tmp.substr(0, pos + 1);
-		tmp.erase(0, pos + 1);
+	while (total < READ_BUDGET) {
+		if (_inputEnd == INPUT_BUFFER_SIZE) {
+			if (_inputStart == 0)
+				break;
+			_compactInput( );
+		}
+		nbytes = recv(_socket, _input + _inputEnd,
+		              std::min< size_t >(INPUT_BUFFER_SIZE - _inputEnd, READ_BUDGET - total), 0);
+		if (_loop)
+			++_loop->getStats( ).recvCalls;
+		if (nbytes > 0) {
+			_inputEnd += nbytes;
+			total += nbytes;
+			continue;
+		}
+		if (nbytes < 0 && errno == EINTR)
+			continue;
+		/* Nothing more to read for now */
+		if (nbytes < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+			break;
+		/* Disconnected or failed, report it once what was already read has been handled */
+		if (total == 0)
+			return (nbytes);
+		break;
 	}
-	std::cout << "\t\t\t\t" << tmp << std::endl;
+	if (total == 0)
+		return (READ_AGAIN);
+
+	LOG(IO, INFO, BLUE "Raw input received from client on socket #" << _socket << ":" CLEAR
+	                << indent(_input + _inputEnd - total, total));
+	return (total);
+}
+
+/* A received buffer has to fit next to the longest partial line */
+typedef char recvBufferFits[RECV_BUFFER_SIZE <= INPUT_BUFFER_SIZE - MAX_TAGS_LENGTH - MAX_LINE_LENGTH ? 1 : -1];
+
+/* Take bytes the reactor received for the client. At most one buffer arrives per loop
+ * iteration, once the lines of the previous one were framed, so it always fits. Returns the
+ * same as read(), minus READ_AGAIN. */
+int Client::receive(const char* data, int nbytes) {
+	if (nbytes <= 0)
+		return (nbytes < 0 ? -1 : 0);
+	if (INPUT_BUFFER_SIZE - _inputEnd < (size_t)nbytes)
+		_compactInput( );
+	std::memcpy(_input + _inputEnd, data, nbytes);
+	_inputEnd += nbytes;
+
+	LOG(IO, INFO, BLUE "Raw input received from client on socket #" << _socket << ":" CLEAR
+	                << indent(_input + _inputEnd - nbytes, nbytes));
 	return (nbytes);
 }
 
-/* Send data to client through socket */
-void Client::reply(const std::string &reply) {
-	size_t sz;
+/* Lines are all framed between reads, only a partial one is left to move to the front */
+void Client::_compactInput( ) {
+	std::memmove(_input, _input + _inputStart, _inputEnd - _inputStart);
+	_inputScan -= _inputStart;
+	_inputEnd -= _inputStart;
+	_inputStart = 0;
+}
 
-	std::cerr << getTimestamp( ) << RED "Sending reply to client on socket #" << _socket
-	          << ":" << CLEAR << std::endl;
-	std::cout << "\t\t\t\t" << reply << std::endl;
+/* Queue data to be sent to the client */
+void Client::reply(const std::string &reply) { this->reply(Payload(reply)); }
 
-	if ((sz = send(_socket, reply.c_str( ), reply.size( ), 0)) < 0)
-		throw std::runtime_error("Error sending message");
+/* Queue a shared buffer to be sent to the client, without copying it */
+void Client::reply(const Payload &reply) {
+	/* Only the owning loop writes to the socket, others hand the reply over to it */
+	if (_loop && _loop != EventLoop::current( )) {
+		_loop->post(this, reply);
+		return;
+	}
+
+	if (reply.empty( ) || _isSendQExceeded)
+		return;
+	if (getSendQLimit( ) && _sendQueueSize + reply.size( ) > getSendQLimit( ))
+		return _exceedSendQ( );
+	LOG(IO, INFO, RED "Sending reply to client on socket #" << _socket << ":" CLEAR
+	                << indent(reply.data( ), reply.size( )));
+	if (_loop)
+		_loop->getTrace( ).record(Trace::REPLY, _socket, reply.size( ));
+	_sendQueue.push_back(reply);
+	_sendQueueSize += reply.size( );
+
+	/* Replies are gathered until the end of the loop iteration. Older ones already pending
+	 * are waiting for the socket to become writable, they keep the order. */
+	if (_sendQueue.size( ) > 1)
+		return;
+	if (_loop)
+		_loop->scheduleFlush(this);
+	else
+		flush( );
 }
 
-/* Check input buffer and return a single message command string */
-std::string Client::retrieveMessage( ) {
-	size_t      it;
-	std::string rawMessage;
+/* Write as much of the send queue as the socket accepts, gathering up to MAX_IOVECS replies
+ * per system call and resuming partial writes where they stopped. A peer that is gone loses
+ * its queue, the read side notices and removes it. */
+void Client::flush( ) {
+	struct iovec  iov[MAX_IOVECS];
+	struct msghdr msg;
+
+	while (!_sendQueue.empty( )) {
+		size_t nbIov = 0;
+		size_t total = 0;
+		for (std::deque< Payload >::iterator it = _sendQueue.begin( );
+		     it != _sendQueue.end( ) && nbIov < MAX_IOVECS; ++it, ++nbIov) {
+			size_t offset       = nbIov ? 0 : _sendOffset;
+			iov[nbIov].iov_base = const_cast< char* >(it->data( )) + offset;
+			iov[nbIov].iov_len  = it->size( ) - offset;
+			total += iov[nbIov].iov_len;
+		}
+
+		/* sendmsg() is writev() with flags, needed to avoid SIGPIPE */
+		std::memset(&msg, 0, sizeof(msg));
+		msg.msg_iov    = iov;
+		msg.msg_iovlen = nbIov;
+		ssize_t sz     = sendmsg(_socket, &msg, MSG_NOSIGNAL);
+		if (_loop)
+			++_loop->getStats( ).sendCalls;
+		if (sz < 0) {
+			if (errno == EINTR)
+				continue;
+			if (errno != EAGAIN && errno != EWOULDBLOCK) {
+				_sendQueue.clear( );
+				_sendOffset    = 0;
+				_sendQueueSize = 0;
+			}
+			return;
+		}
+		if (_loop)
+			_loop->getStats( ).bytesOut += sz;
 
-	/* If there remains text after the "\r\n", store it. */
-	it = _inputBuffer.find("\r\n");
-	if (it != std::string::npos) {
-		rawMessage   = _inputBuffer.substr(0, it + 2);
-		_inputBuffer = _inputBuffer.substr(it + 2, _inputBuffer.size( ));
+		/* Drop what was written, the first remaining reply may be partially sent */
+		_sendQueueSize -= sz;
+		for (size_t left = sz; left;) {
+			size_t frontLeft = _sendQueue.front( ).size( ) - _sendOffset;
+			if (left < frontLeft) {
+				_sendOffset += left;
+				break;
+			}
+			left -= frontLeft;
+			_sendQueue.pop_front( );
+			_sendOffset = 0;
+		}
+
+		/* A short write means the socket buffer is full */
+		if ((size_t)sz < total)
+			return;
 	}
+}
+
+/* Slow consumer: drop what it has not read yet, keeping a partially sent line whole, and let
+ * its loop disconnect it. Further replies are ignored. */
+void Client::_exceedSendQ( ) {
+	Payload error(ERR_CLOSINGLINK(_username, getAddress( ), "Max SendQ exceeded"));
 
-	return rawMessage;
+	LOG(CONNECTIONS, WARN, YELLOW "Max SendQ exceeded for client on socket #" << _socket << CLEAR);
+	_sendQueue.resize(_sendOffset ? 1 : 0);
+	_sendQueueSize = _sendOffset ? _sendQueue.front( ).size( ) - _sendOffset : 0;
+	_sendQueue.push_back(error);
+	_sendQueueSize += error.size( );
+	_isSendQExceeded = true;
+
+	if (_loop) {
+		if (_sendQueue.size( ) == 1)
+			_loop->scheduleFlush(this);
+		_loop->evict(this);
+	}
+}
+
+/* Frame the next line out of the input buffer without copying it. Lines end with "\n", the
+ * "\r" usually before it is stripped and empty lines are skipped. The line points into the
+ * buffer and stays valid until the next read(). A line longer than MAX_LINE_LENGTH, not counting
+ * up to MAX_TAGS_LENGTH of message tags, is reported once and dropped, along with the rest of it
+ * still to come. Message tags with nothing after them are reported as malformed. */
+Client::LineStatus Client::nextLine(const char*& line, size_t& length) {
+	for (;;) {
+		const char* end =
+		  static_cast< const char* >(std::memchr(_input + _inputScan, '\n', _inputEnd - _inputScan));
+
+		/* Lines may carry message tags on top of the RFC 1459 limit */
+		bool   tagged = _inputEnd > _inputStart && _input[_inputStart] == '@';
+		size_t limit  = tagged ? MAX_TAGS_LENGTH + MAX_LINE_LENGTH : MAX_LINE_LENGTH;
+
+		if (!end) {
+			/* Partial line, already too long to ever fit */
+			if (_inputEnd - _inputStart >= limit) {
+				bool wasDiscarding = _isDiscarding;
+				_inputStart = _inputScan = _inputEnd = 0;
+				_isDiscarding = true;
+				return wasDiscarding ? NO_LINE : LINE_TOO_LONG;
+			}
+			_inputScan = _inputEnd;
+			return NO_LINE;
+		}
+
+		size_t start = _inputStart;
+		length       = end - (_input + start);
+		_inputStart = _inputScan = end - _input + 1;
+		/* Fully framed, the next read can start from the front. The data stays in place. */
+		if (_inputStart == _inputEnd)
+			_inputStart = _inputScan = _inputEnd = 0;
+
+		if (_isDiscarding) {
+			_isDiscarding = false;
+			continue;
+		}
+		if (length && _input[start + length - 1] == '\r')
+			--length;
+		if (length && _input[start] == '@') {
+			const char* space = static_cast< const char* >(
+			  std::memchr(_input + start, ' ', std::min< size_t >(length, MAX_TAGS_LENGTH)));
+			/* Tags are budgeted separately from the rest of the line */
+			if (!space)
+				return length > MAX_TAGS_LENGTH ? LINE_TOO_LONG : LINE_MALFORMED;
+			if (length - (space + 1 - (_input + start)) > MAX_LINE_LENGTH - 2)
+				return LINE_TOO_LONG;
+		}
+		else if (length > MAX_LINE_LENGTH - 2)
+			return LINE_TOO_LONG;
+		if (length) {
+			line = _input + start;
+			return LINE_READY;
+		}
+	}
 }
 
 const std::string Client::getAddress( ) const {
@@ -108,4 +353,7 @@ const std::string Client::getAddress( ) const {
 		return ("127.0.0.1");
 	else
 		return std::string(buf);
-}
\ No newline at end of file
+}
+
+/* Connected from this host, 127.0.0.0/8 */
+bool Client::isLoopback( ) const { return (ntohl(_address.sin_addr.s_addr) >> 24) == 127; }
\ No newline at end of file
@@ -0,0 +1,28 @@
+/* Local Includes */
+#include "Clock.hpp"
+
+__thread Clock::State Clock::_state = {0, 0, 0, -1, {0}};
+
+void Clock::update( ) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	_state.monotonic = (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+	clock_gettime(CLOCK_REALTIME, &ts);
+	_state.wall = ts.tv_sec;
+	_state.wallMs = (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+const char* Clock::timestamp( ) {
+	if (wall( ) != _state.formattedWall) {
+		format(_state.wall, _state.timestamp, sizeof(_state.timestamp));
+		_state.formattedWall = _state.wall;
+	}
+	return _state.timestamp;
+}
+
+size_t Clock::format(std::time_t time, char* out, size_t size) {
+	struct tm local;
+
+	return strftime(out, size, "[%a %b %d %Y %X] : ", localtime_r(&time, &local));
+}
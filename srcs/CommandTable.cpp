@@ -0,0 +1,91 @@
+/* Local Includes */
+#include "CommandTable.hpp"
+
+/* System Includes */
+#include <cstring>
+#include <strings.h>
+
+/* Slots laid out by _hash(). The multipliers were searched for so that every name lands in
+ * its own slot, adding a command means finding new ones if it collides. */
+const CommandTable::Entry CommandTable::_slots[SLOTS] = {
+	{"part", PART},
+	{NULL, UNKNOWN},
+	{"kick", KICK},
+	{"pass", PASS},
+	{"join", JOIN},
+	{"quit", QUIT},
+	{NULL, UNKNOWN},
+	{"ping", PING},
+	{NULL, UNKNOWN},
+	{"who", WHO},
+	{"cap", CAP},
+	{NULL, UNKNOWN},
+	{"list", LIST},
+	{"tracedump", TRACEDUMP},
+	{"mode", MODE},
+	{"user", USER},
+	{NULL, UNKNOWN},
+	{"nick", NICK},
+	{"privmsg", PRIVMSG},
+	{NULL, UNKNOWN},
+	{"invite", INVITE},
+	{"notice", NOTICE},
+	{"away", AWAY},
+	{"pong", PONG},
+	{"topic", TOPIC},
+	{NULL, UNKNOWN},
+	{"names", NAMES},
+	{NULL, UNKNOWN},
+	{NULL, UNKNOWN},
+	{"shutdown", SHUTDOWN},
+	{NULL, UNKNOWN},
+	{"whois", WHOIS}
+};
+
+/* Commands that report a missing parameter with their own error (NICK, PRIVMSG, WHOIS) or
+ * ignore it (MODE, NOTICE, WHO) need none here */
+const CommandTable::Info CommandTable::_info[COUNT] = {
+	/*				minParams	registered	floodCost	readOnly */
+	/* UNKNOWN */	{0,			true,		1,			true},
+	/* AWAY */		{0,			true,		1,			false},
+	/* CAP */		{1,			false,		0,			false},
+	/* INVITE */	{2,			true,		2,			false},
+	/* JOIN */		{1,			true,		2,			false},
+	/* KICK */		{2,			true,		2,			false},
+	/* LIST */		{0,			true,		3,			true},
+	/* MODE */		{0,			true,		1,			false},
+	/* NAMES */		{0,			true,		3,			true},
+	/* NICK */		{0,			false,		2,			false},
+	/* NOTICE */	{0,			true,		1,			false},
+	/* PART */		{1,			true,		2,			false},
+	/* PASS */		{1,			false,		1,			false},
+	/* PING */		{0,			true,		0,			true},
+	/* PONG */		{0,			true,		0,			true},
+	/* PRIVMSG */	{0,			true,		1,			false},
+	/* QUIT */		{0,			true,		0,			false},
+	/* SHUTDOWN */	{0,			true,		0,			false},
+	/* TOPIC */		{1,			true,		1,			false},
+	/* TRACEDUMP */	{0,			true,		3,			false},
+	/* USER */		{1,			false,		1,			false},
+	/* WHO */		{0,			true,		3,			true},
+	/* WHOIS */		{0,			true,		1,			true}
+};
+
+/* Case folding is done while hashing, as ASCII letters only differ by bit 0x20 */
+size_t CommandTable::_hash(const char* name, size_t length) {
+	const unsigned char* chars = reinterpret_cast< const unsigned char* >(name);
+
+	return ((chars[0] | 0x20) * 5 + (chars[1] | 0x20) * 8 + (chars[length - 1] | 0x20) * 29 + length)
+	     & (SLOTS - 1);
+}
+
+CommandTable::Id CommandTable::lookup(const char* name, size_t length) {
+	/* Shorter than any known command */
+	if (length < 3)
+		return UNKNOWN;
+
+	const Entry& entry = _slots[_hash(name, length)];
+	if (entry.name && std::strlen(entry.name) == length && strncasecmp(entry.name, name, length) == 0)
+		return entry.id;
+	return UNKNOWN;
+}
@@ -0,0 +1,57 @@
+/* Local Includes */
+#include "Config.hpp"
+
+/* System Includes */
+#include <cstdlib>
+#include <sstream>
+#include <unistd.h>
+
+/* Default settings */
+Config::Config( )
+  : reactor("epoll"), threads(1), cpuAffinity("none"), sendqUnregistered(16 * 1024),
+    sendqRegistered(1024 * 1024), tcpCork(false), logLevel("info"),
+    logCategories("server,connections,commands") {}
+
+/* Override defaults with IRC_* environment variables */
+void Config::loadEnvironment( ) {
+	const char* value;
+
+	if ((value = std::getenv("IRC_REACTOR")) && *value)
+		reactor = value;
+	if ((value = std::getenv("IRC_THREADS")) && std::atoi(value) > 0)
+		threads = std::atoi(value);
+	if ((value = std::getenv("IRC_CPU_AFFINITY")) && *value)
+		cpuAffinity = value;
+	if ((value = std::getenv("IRC_SENDQ_UNREGISTERED")) && std::atol(value) > 0)
+		sendqUnregistered = std::atol(value);
+	if ((value = std::getenv("IRC_SENDQ")) && std::atol(value) > 0)
+		sendqRegistered = std::atol(value);
+	if ((value = std::getenv("IRC_TCP_CORK")))
+		tcpCork = std::atoi(value) != 0;
+	if ((value = std::getenv("IRC_ADMIN_PASSWORD")))
+		adminPassword = value;
+	if ((value = std::getenv("IRC_LOG_LEVEL")) && *value)
+		logLevel = value;
+	if ((value = std::getenv("IRC_LOG")))
+		logCategories = value;
+}
+
+/* Resolve the CPU affinity setting for a given event loop */
+int Config::cpuForLoop(size_t loop) const {
+	if (cpuAffinity == "none")
+		return -1;
+
+	/* One loop per online CPU, wrapping around if there are more loops than CPUs */
+	if (cpuAffinity == "auto") {
+		long nbCpus = sysconf(_SC_NPROCESSORS_ONLN);
+		return nbCpus > 0 ? loop % nbCpus : -1;
+	}
+
+	/* Explicit comma-separated list, loops beyond its end are left unpinned */
+	std::istringstream list(cpuAffinity);
+	std::string        cpu;
+	for (size_t i = 0; std::getline(list, cpu, ','); ++i)
+		if (i == loop)
+			return std::atoi(cpu.c_str( ));
+	return -1;
+}
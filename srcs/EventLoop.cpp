@@ -0,0 +1,458 @@
+/* Local Includes */
+#include "EventLoop.hpp"
+#include "Client.hpp"
+#include "Clock.hpp"
+#include "Logger.hpp"
+#include "Server.hpp"
+#include "defines.h"
+
+/* System Includes */
+#include <algorithm>
+#include <errno.h>
+#include <fcntl.h>
+#include <cstring>
+#include <iomanip>
+#include <netinet/tcp.h>
+#include <sstream>
+#include <stdexcept>
+#include <unistd.h>
+
+/* Loop running on the current thread */
+static __thread EventLoop* t_currentLoop = NULL;
+
+/*****************************/
+/* Constructor & Destructor */
+/*****************************/
+
+EventLoop::EventLoop(Server* server, size_t id, const std::string& backend, int cpu)
+  : _server(server), _id(id), _reactor(Reactor::create(backend)), _hasThread(false),
+    _cpu(cpu), _cork(server->getConfig( ).tcpCork), _listenFd(-1), _listening(false), _traceDumpRequested(0) {
+	_stats.iterations = 0;
+	_stats.timeouts   = 0;
+	_stats.wakeups    = 0;
+	_stats.sendqDrops = 0;
+	_stats.commands   = 0;
+	_stats.recvCalls  = 0;
+	_stats.sendCalls  = 0;
+	_stats.corkCalls  = 0;
+	_stats.bytesOut   = 0;
+	_stats.lockWaitNs = 0;
+
+	/* Set up the pipe used by other threads to wake this loop up */
+	if (pipe(_wakeFds) < 0) {
+		delete _reactor;
+		throw std::runtime_error("Unable to create event loop wake pipe");
+	}
+	fcntl(_wakeFds[0], F_SETFL, O_NONBLOCK);
+	fcntl(_wakeFds[1], F_SETFL, O_NONBLOCK);
+	_reactor->add(_wakeFds[0], Reactor::READABLE, this);
+}
+
+EventLoop::~EventLoop( ) {
+	join( );
+	delete _reactor;
+	close(_wakeFds[0]);
+	close(_wakeFds[1]);
+}
+
+EventLoop* EventLoop::current( ) { return t_currentLoop; }
+
+/***********************************/
+/*          Loop Operation         */
+/***********************************/
+
+/* Run the loop on a new thread */
+void EventLoop::start( ) {
+	if (pthread_create(&_thread, NULL, _threadMain, this) != 0)
+		throw std::runtime_error("Unable to start event loop thread");
+	_hasThread = true;
+}
+
+/* Wait for the loop thread to exit */
+void EventLoop::join( ) {
+	if (!_hasThread)
+		return;
+	pthread_join(_thread, NULL);
+	_hasThread = false;
+}
+
+/* Main loop: read from ready sockets, process their input and fired timers under the server
+ * lock, then deliver replies posted by other loops */
+void EventLoop::run( ) {
+	t_currentLoop = this;
+	if (_cpu >= 0)
+		_pin(_cpu);
+
+	while (g_status == ONLINE) {
+		/* SIGUSR1 asks every loop for a flight recorder dump */
+		if (g_traceDump && __sync_bool_compare_and_swap(&g_traceDump, 1, 0))
+			_server->dumpTraces( );
+
+		/* Sleep until there is activity or the next timer is due, only ready sockets are returned.
+		 * Slow consumers found while delivering the mailbox are dropped without waiting. */
+		int timeout = _evicted.empty( ) && _accepted.empty( ) ? _timers.timeout(Clock::monotonic( )) : 0;
+		if (_reactor->wait(_events, timeout) < 0) {
+			if (errno == EINTR) // If server is terminated through SIGINT, wait will fail
+				continue;
+			throw std::runtime_error("Error when attempting to poll");
+		}
+		/* The only clock read of the iteration, everything below uses the cached time */
+		Clock::update( );
+		++_stats.iterations;
+		if (_events.empty( ))
+			++_stats.timeouts;
+
+		/* Socket I/O does not need the server lock */
+		_reads.clear( );
+		for (size_t i = 0; i < _events.size( ); ++i) {
+			if (_events[i].fd == _wakeFds[0]) {
+				++_stats.wakeups;
+				_drainWakePipe( );
+			}
+			else if (_events[i].fd == _listenFd) {
+				if (_events[i].events & Reactor::ACCEPT)
+					_accepted.push_back(_events[i].result);
+				else
+					_server->handleConnections(this, _listenFd);
+			}
+			else {
+				Client* client = static_cast< Client* >(_events[i].data);
+				if (_events[i].events & Reactor::WRITABLE) {
+					client->flush( );
+					updateInterest(client);
+				}
+				/* Data the reactor received itself */
+				if (_events[i].events & Reactor::RECEIVE) {
+					int nbytes = client->receive(_events[i].buffer, _events[i].result);
+					_reads.push_back(std::make_pair(client, nbytes));
+				}
+				/* A readiness report may be stale, only input or a disconnection is handled */
+				else if (_events[i].events & Reactor::READABLE) {
+					int nbytes = client->read( );
+					if (nbytes != Client::READ_AGAIN)
+						_reads.push_back(std::make_pair(client, nbytes));
+				}
+			}
+		}
+		if (!_accepted.empty( ))
+			_registerAccepted( );
+
+		uint64_t now     = Clock::monotonic( );
+		Timer*   expired = NULL;
+		_timers.advance(now);
+
+		/* Commands touch shared server state, take the lock once for the whole batch */
+		if (!_reads.empty( ) || (expired = _timers.popExpired( ))) {
+			uint64_t   start = Trace::now( );
+			ScopedLock lock(_server->getLock( ));
+			_stats.lockWaitNs += Trace::now( ) - start;
+			for (size_t i = 0; i < _reads.size( ); ++i)
+				_server->handleMessages(_reads[i].first, _reads[i].second);
+			/* Timers are popped one by one, handling one may cancel the others */
+			if (!expired)
+				expired = _timers.popExpired( );
+			for (; expired; expired = _timers.popExpired( )) {
+				if (expired == &_acceptTimer)
+					_resumeAccept( );
+				else
+					_server->handleTimeout(static_cast< Client* >(expired->data), now);
+			}
+		}
+
+		/* Clients are only removed under the server lock, once removed no other loop can post to
+		 * them. Draining the mailbox after the last removal and before deleting them delivers or
+		 * skips everything still addressed to them. */
+		_dropEvicted( );
+		_drainMailbox( );
+		_flushReplies( );
+		_reapDiscarded( );
+		if (_traceDumpRequested && __sync_bool_compare_and_swap(&_traceDumpRequested, 1, 0))
+			_dumpTrace( );
+	}
+
+	/* Deliver what was posted while shutting down */
+	_dropEvicted( );
+	_drainMailbox( );
+	_flushReplies( );
+	_reapDiscarded( );
+	t_currentLoop = NULL;
+}
+
+/* Interrupt a blocking wait, can be called from any thread */
+void EventLoop::wake( ) {
+	char    byte = 0;
+	ssize_t ret  = write(_wakeFds[1], &byte, 1);
+	(void)ret; // A full pipe already guarantees a wakeup
+}
+
+/* Have the loop dump its flight recorder at the end of its current iteration, can be called
+ * from any thread */
+void EventLoop::requestTraceDump( ) {
+	__sync_bool_compare_and_swap(&_traceDumpRequested, 0, 1);
+	wake( );
+}
+
+/* Log the loop counters. Socket calls per command is what batching replies brings down, it
+ * is logged at shutdown and with every trace dump so that it can be read under load. */
+void EventLoop::logStats( ) const {
+	uint64_t calls = _stats.recvCalls + _stats.sendCalls + _stats.corkCalls;
+
+	LOG(SERVER, INFO, "Event loop " << _id << ": " << _stats.iterations << " iterations, "
+	                  << _stats.timeouts << " timer wakeups, " << _stats.wakeups << " cross-thread wakeups, "
+	                  << _stats.sendqDrops << " SendQ drops, " << _stats.lockWaitNs / 1000000
+	                  << " ms waiting for the server lock");
+	LOG(SERVER, INFO, "Event loop " << _id << ": " << _stats.commands << " commands, "
+	                  << _stats.recvCalls << " recv, " << _stats.sendCalls << " sendmsg, " << _stats.corkCalls
+	                  << " cork calls, " << _stats.bytesOut << " bytes sent, " << std::fixed
+	                  << std::setprecision(2) << (_stats.commands ? double(calls) / _stats.commands : 0.0)
+	                  << " socket calls per command");
+}
+
+/***********************************/
+/*        Socket Management        */
+/***********************************/
+
+/* Accept connections from this listening socket */
+void EventLoop::listen(int fd) {
+	_listenFd = fd;
+	_resumeAccept( );
+}
+
+/* Stop watching the listener for ACCEPT_BACKOFF milliseconds. Out of file descriptors, it would
+ * stay readable with every accept failing. Pending connections wait in the listen backlog. */
+void EventLoop::pauseAccept( ) {
+	if (_acceptTimer.isPending( ))
+		return;
+	_stopAccept( );
+	_timers.schedule(_acceptTimer, Clock::monotonic( ) + ACCEPT_BACKOFF);
+}
+
+/* Start watching a client socket, must be called by the owning loop. The client's timer
+ * starts with the registration deadline. */
+void EventLoop::watch(Client* client) {
+	_reactor->add(client->getSocket( ), Reactor::READABLE | Reactor::RECEIVE, client);
+	_timers.schedule(client->getTimer( ), Clock::monotonic( ) + REG_TIMEOUT * 1000);
+}
+
+/* Stop watching a client socket, must be called by the owning loop. The client is only deleted
+ * at the end of the iteration, as events and deliveries already collected may still point to it. */
+void EventLoop::discard(Client* client) {
+	_trace.record(Trace::DISCONNECT, client->getSocket( ), 0);
+	_reactor->remove(client->getSocket( ));
+	_timers.cancel(client->getTimer( ));
+	client->setClosing(true);
+	_discarded.push_back(client);
+}
+
+/* Watch a client socket for writability only while it has output queued, must be called by
+ * the owning loop */
+void EventLoop::updateInterest(Client* client) {
+	bool pending = client->hasPendingOutput( );
+
+	if (client->isClosing( ) || pending == client->isPollingOut( ))
+		return;
+	_reactor->modify(client->getSocket( ), Reactor::READABLE | Reactor::RECEIVE | (pending ? Reactor::WRITABLE : 0),
+	                 client);
+	client->setPollingOut(pending);
+}
+
+/* Write a client's queued replies at the end of the iteration, all at once. Called when its
+ * queue stops being empty, a queue that stays non-empty is flushed on writability instead. */
+void EventLoop::scheduleFlush(Client* client) { _flushes.push_back(client); }
+
+/* Disconnect a client at the end of the iteration. Eviction can be decided in the middle of a
+ * broadcast, when the client cannot be removed from its channels yet. */
+void EventLoop::evict(Client* client) { _evicted.push_back(client); }
+
+/* (Re)arm a client's timer, must be called by the owning loop */
+void EventLoop::schedule(Client* client, uint64_t when) {
+	_timers.schedule(client->getTimer( ), when);
+}
+
+/***********************************/
+/*        Cross-loop Mailbox       */
+/***********************************/
+
+/* Hand a newly accepted client over to this loop */
+void EventLoop::adopt(Client* client) {
+	Delivery delivery = {client, Payload( ), true};
+	bool     wasEmpty;
+
+	{
+		ScopedLock lock(_mailboxLock);
+		wasEmpty = _mailbox.empty( );
+		_mailbox.push_back(delivery);
+	}
+	if (wasEmpty)
+		wake( );
+}
+
+/* Queue data to be sent by this loop to one of its clients */
+void EventLoop::post(Client* client, const Payload& data) {
+	Delivery delivery = {client, data, false};
+	bool     wasEmpty;
+
+	{
+		ScopedLock lock(_mailboxLock);
+		wasEmpty = _mailbox.empty( );
+		_mailbox.push_back(delivery);
+	}
+	if (wasEmpty)
+		wake( );
+}
+
+/***********************************/
+/*         Private Functions       */
+/***********************************/
+
+void* EventLoop::_threadMain(void* loop) {
+	try {
+		static_cast< EventLoop* >(loop)->run( );
+	}
+	catch (const std::exception& e) {
+		LOG(SERVER, ERROR, RED "Event loop stopped: " << e.what( ) << CLEAR);
+		g_status = OFFLINE;
+		static_cast< EventLoop* >(loop)->_server->wakeLoops( );
+	}
+	return NULL;
+}
+
+/* Pin the calling thread to a CPU */
+void EventLoop::_pin(int cpu) {
+#ifdef __linux__
+	cpu_set_t set;
+
+	CPU_ZERO(&set);
+	CPU_SET(cpu, &set);
+	if (pthread_setaffinity_np(pthread_self( ), sizeof(set), &set) != 0)
+		LOG(SERVER, WARN, YELLOW "Unable to pin event loop " << _id << " to CPU " << cpu << CLEAR);
+#else
+	LOG(SERVER, WARN, YELLOW "CPU pinning is not supported, event loop " << _id << " left unpinned" CLEAR);
+#endif
+}
+
+/* Empty the wake pipe */
+void EventLoop::_drainWakePipe( ) {
+	char buf[64];
+
+	while (::read(_wakeFds[0], buf, sizeof(buf)) > 0)
+		;
+}
+
+/* Register the connections the reactor accepted, ACCEPT_BATCH per iteration like accept()
+ * does. The reactor keeps accepting across iterations: once ACCEPT_QUEUE connections are
+ * waiting, the listener is left alone until they are registered, and new ones wait in the
+ * listen backlog instead of piling up faster than the loop serves them. */
+void EventLoop::_registerAccepted( ) {
+	size_t count = std::min< size_t >(_accepted.size( ), ACCEPT_BATCH);
+
+	_acceptBatch.assign(_accepted.begin( ), _accepted.begin( ) + count);
+	_accepted.erase(_accepted.begin( ), _accepted.begin( ) + count);
+	_server->handleAccepted(this, _acceptBatch);
+	if (_accepted.size( ) >= ACCEPT_QUEUE)
+		_stopAccept( );
+	else
+		_resumeAccept( );
+}
+
+/* Stop watching the listener, which cancels what the reactor has in flight for it */
+void EventLoop::_stopAccept( ) {
+	if (!_listening)
+		return;
+	_reactor->remove(_listenFd);
+	_listening = false;
+}
+
+/* Watch the listener again, unless accepting is paused or too many connections are waiting */
+void EventLoop::_resumeAccept( ) {
+	if (_listening || _listenFd < 0 || _acceptTimer.isPending( ) || _accepted.size( ) >= ACCEPT_QUEUE)
+		return;
+	_reactor->add(_listenFd, Reactor::READABLE | Reactor::ACCEPT, nullptr);
+	_listening = true;
+}
+
+/* Process everything posted by other loops */
+void EventLoop::_drainMailbox( ) {
+	{
+		ScopedLock lock(_mailboxLock);
+		if (_mailbox.empty( ))
+			return;
+		_deliveries.swap(_mailbox);
+	}
+	for (size_t i = 0; i < _deliveries.size( ); ++i) {
+		if (_deliveries[i].adopt)
+			watch(_deliveries[i].client);
+		else if (!_deliveries[i].client->isClosing( ))
+			_deliveries[i].client->reply(_deliveries[i].data);
+	}
+	_deliveries.clear( );
+}
+
+/* Disconnect the slow consumers found since the last call. Their QUIT may push more clients
+ * over the limit, which are handled in the same pass. Those found while draining the mailbox
+ * wait for the next iteration, which then does not block. */
+void EventLoop::_dropEvicted( ) {
+	if (_evicted.empty( ))
+		return;
+
+	uint64_t   start = Trace::now( );
+	ScopedLock lock(_server->getLock( ));
+	_stats.lockWaitNs += Trace::now( ) - start;
+	for (size_t i = 0; i < _evicted.size( ); ++i) {
+		if (_evicted[i]->isClosing( ))
+			continue;
+		_server->dropClient(_evicted[i], "Max SendQ exceeded");
+		++_stats.sendqDrops;
+	}
+	_evicted.clear( );
+}
+
+/* Flush every client that was replied to during this iteration, one gathered write each */
+void EventLoop::_flushReplies( ) {
+	for (size_t i = 0; i < _flushes.size( ); ++i) {
+		Client* client = _flushes[i];
+		if (!client->hasPendingOutput( ))
+			continue;
+		if (_cork)
+			_setCork(client->getSocket( ), 1);
+		client->flush( );
+		if (_cork)
+			_setCork(client->getSocket( ), 0);
+		updateInterest(client);
+	}
+	_flushes.clear( );
+}
+
+void EventLoop::_setCork(int fd, int on) {
+#ifdef TCP_CORK
+	setsockopt(fd, IPPROTO_TCP, TCP_CORK, &on, sizeof(on));
+	++_stats.corkCalls;
+#else
+	(void)fd;
+	(void)on;
+#endif
+}
+
+/* Delete the clients removed during this iteration, closing their sockets. Output still
+ * queued, such as a closing ERROR, gets a last chance to be written. */
+void EventLoop::_reapDiscarded( ) {
+	for (size_t i = 0; i < _discarded.size( ); ++i) {
+		_discarded[i]->flush( );
+		delete _discarded[i];
+	}
+	_discarded.clear( );
+}
+
+/* Write the flight recorder to ircserv-<pid>-<loop>.trace in the working directory, and log the
+ * counters along with it */
+void EventLoop::_dumpTrace( ) {
+	std::ostringstream path;
+
+	path << "ircserv-" << getpid( ) << "-" << _id << ".trace";
+	if (_trace.dump(path.str( ), _id))
+		LOG(SERVER, INFO, "Event loop " << _id << " trace dumped to " << path.str( ));
+	else
+		LOG(SERVER, ERROR, RED "Unable to dump event loop " << _id << " trace to " << path.str( )
+		                   << ": " << strerror(errno) << CLEAR);
+	logStats( );
+}
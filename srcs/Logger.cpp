@@ -0,0 +1,220 @@
+/* Local Includes */
+#include "Logger.hpp"
+#include "Clock.hpp"
+#include "Config.hpp"
+#include "defines.h"
+
+/* System Includes */
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <pthread.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+/* Ring slot. The sequence number tells whose turn it is: equal to the position when free
+ * for a producer, position + 1 once filled for the writer thread. */
+struct LogEntry {
+	size_t				sequence;
+	Logger::Level		level;
+	Logger::Category	category;
+	std::time_t			time;
+	size_t				length;		/* Message length before truncation */
+	char				text[LOG_LINE_MAX];
+};
+
+static const char* const s_categoryNames[Logger::CATEGORIES] = {"server", "connections", "commands",
+                                                                "io"};
+static const char* const s_levelNames[Logger::SILENT]        = {"debug", "info", "warn", "error"};
+
+Logger::Level Logger::_thresholds[Logger::CATEGORIES] = {Logger::INFO, Logger::INFO, Logger::INFO,
+                                                         Logger::WARN};
+
+static LogEntry        s_ring[LOG_RING_SIZE];
+static size_t          s_enqueuePos = 0;	/* Next slot claimed by a producer */
+static size_t          s_dequeuePos = 0;	/* Next slot read by the writer thread */
+static size_t          s_dropped    = 0;	/* Messages lost to a full ring */
+static int             s_sleeping   = 0;	/* Writer thread waiting, producers must signal it */
+static bool            s_stopping   = false;
+static bool            s_running    = false;
+static pthread_t       s_thread;
+static pthread_mutex_t s_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  s_cond  = PTHREAD_COND_INITIALIZER;
+
+/***********************************/
+/*             Helpers             */
+/***********************************/
+
+/* Timestamp prefix, only reformatted when the second changes */
+static const std::string& timestamp(std::time_t time) {
+	static std::time_t last = -1;
+	static std::string formatted;
+	char               output[48];
+
+	if (time != last) {
+		formatted.assign(output, Clock::format(time, output, sizeof(output)));
+		last = time;
+	}
+	return formatted;
+}
+
+static void format(std::string& out, const std::string& prefix, const char* text, size_t length,
+                   bool truncated) {
+	out += prefix;
+	out.append(text, length);
+	if (truncated)
+		out += " [...]";
+	out += '\n';
+}
+
+/* Warnings and errors go to stderr, everything else to stdout */
+static void output(Logger::Level level, const std::string& text) {
+	std::ostream& stream = (level >= Logger::WARN) ? std::cerr : std::cout;
+	stream.write(text.data( ), text.size( ));
+	stream.flush( );
+}
+
+static bool isPending( ) {
+	LogEntry& entry = s_ring[s_dequeuePos & (LOG_RING_SIZE - 1)];
+	return __atomic_load_n(&entry.sequence, __ATOMIC_SEQ_CST) == s_dequeuePos + 1;
+}
+
+/* Write out everything in the ring, one write per stream */
+static void drain( ) {
+	static size_t reported = 0;
+	std::string   out;
+	std::string   err;
+
+	while (isPending( )) {
+		LogEntry& entry = s_ring[s_dequeuePos & (LOG_RING_SIZE - 1)];
+		format(entry.level >= Logger::WARN ? err : out, timestamp(entry.time), entry.text,
+		       std::min(entry.length, sizeof(entry.text)), entry.length > sizeof(entry.text));
+		/* Hand the slot back to producers for the next lap */
+		__atomic_store_n(&entry.sequence, s_dequeuePos + LOG_RING_SIZE, __ATOMIC_RELEASE);
+		++s_dequeuePos;
+	}
+
+	size_t dropped = __atomic_load_n(&s_dropped, __ATOMIC_RELAXED);
+	if (dropped != reported) {
+		std::ostringstream warning;
+		warning << YELLOW << dropped - reported << " log messages dropped, ring full" CLEAR;
+		Clock::update( );
+		format(err, timestamp(Clock::wall( )), warning.str( ).data( ), warning.str( ).size( ), false);
+		reported = dropped;
+	}
+
+	if (!out.empty( ))
+		output(Logger::INFO, out);
+	if (!err.empty( ))
+		output(Logger::ERROR, err);
+}
+
+/***********************************/
+/*            Lifecycle            */
+/***********************************/
+
+/* IRC_LOG_LEVEL sets the lowest level written, IRC_LOG the comma-separated categories it
+ * applies to ("all" or "none" also work) */
+void Logger::start(const Config& config) {
+	Level level = INFO;
+	for (int i = 0; i < SILENT; ++i)
+		if (config.logLevel == s_levelNames[i])
+			level = static_cast< Level >(i);
+
+	std::string categories = "," + config.logCategories + ",";
+	for (int i = 0; i < CATEGORIES; ++i) {
+		bool enabled = categories.find(std::string(",") + s_categoryNames[i] + ",") != std::string::npos
+		            || config.logCategories == "all";
+		_thresholds[i] = enabled ? level : std::max(level, WARN);
+	}
+
+	for (size_t i = 0; i < LOG_RING_SIZE; ++i)
+		s_ring[i].sequence = i;
+	s_enqueuePos = 0;
+	s_dequeuePos = 0;
+	s_stopping   = false;
+	if (pthread_create(&s_thread, NULL, _threadMain, NULL) == 0)
+		s_running = true;
+}
+
+/* Write out what is left and go back to synchronous logging, once no other thread logs */
+void Logger::stop( ) {
+	if (!s_running)
+		return;
+	pthread_mutex_lock(&s_mutex);
+	s_stopping = true;
+	pthread_cond_signal(&s_cond);
+	pthread_mutex_unlock(&s_mutex);
+	pthread_join(s_thread, NULL);
+	s_running = false;
+}
+
+/***********************************/
+/*             Logging             */
+/***********************************/
+
+/* Bounded multi-producer queue (Vyukov): claim a slot by advancing the enqueue position,
+ * fill it, then publish it through its sequence number */
+void Logger::write(Category category, Level level, const std::string& message) {
+	if (!s_running) {
+		std::string line;
+		format(line, Clock::timestamp( ), message.data( ), message.size( ), false);
+		return output(level, line);
+	}
+
+	size_t    pos = __atomic_load_n(&s_enqueuePos, __ATOMIC_RELAXED);
+	LogEntry* entry;
+	for (;;) {
+		entry        = &s_ring[pos & (LOG_RING_SIZE - 1)];
+		size_t  seq  = __atomic_load_n(&entry->sequence, __ATOMIC_ACQUIRE);
+		ssize_t diff = static_cast< ssize_t >(seq - pos);
+		if (diff == 0) {
+			if (__atomic_compare_exchange_n(&s_enqueuePos, &pos, pos + 1, true, __ATOMIC_RELAXED,
+			                                __ATOMIC_RELAXED))
+				break;
+		}
+		/* The writer thread has not freed this slot yet */
+		else if (diff < 0) {
+			__atomic_add_fetch(&s_dropped, 1, __ATOMIC_RELAXED);
+			return;
+		}
+		else
+			pos = __atomic_load_n(&s_enqueuePos, __ATOMIC_RELAXED);
+	}
+
+	entry->level    = level;
+	entry->category = category;
+	entry->time     = Clock::wall( );
+	entry->length   = message.size( );
+	std::memcpy(entry->text, message.data( ), std::min(message.size( ), sizeof(entry->text)));
+	__atomic_store_n(&entry->sequence, pos + 1, __ATOMIC_SEQ_CST);
+
+	/* Only take the lock when the writer thread went to sleep. Both sides publish then check
+	 * in sequentially consistent order: either it sees this entry, or this sees it sleeping. */
+	if (__atomic_load_n(&s_sleeping, __ATOMIC_SEQ_CST)) {
+		pthread_mutex_lock(&s_mutex);
+		pthread_cond_signal(&s_cond);
+		pthread_mutex_unlock(&s_mutex);
+	}
+}
+
+void* Logger::_threadMain(void* unused) {
+	(void)unused;
+	for (;;) {
+		drain( );
+
+		pthread_mutex_lock(&s_mutex);
+		__atomic_store_n(&s_sleeping, 1, __ATOMIC_SEQ_CST);
+		if (!isPending( ) && !s_stopping)
+			pthread_cond_wait(&s_cond, &s_mutex);
+		__atomic_store_n(&s_sleeping, 0, __ATOMIC_RELAXED);
+		bool stopping = s_stopping;
+		pthread_mutex_unlock(&s_mutex);
+
+		if (stopping && !isPending( ))
+			break;
+	}
+	drain( );
+	return NULL;
+}
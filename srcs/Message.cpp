@@ -1,49 +1,102 @@
 #include "Message.hpp"
 #include "defines.h"
 
-Message::Message(Client* client, std::string raw) : _client(client)
+/* System Includes */
+#include <cstring>
+
+Message::Message(Client* client, const char* line, size_t length)
+	: _client(client), _line(line), _hasPrefix(false), _nbMiddle(0), _hasTrailing(false)
 {
-    size_t   pos    = 0;
-    _hasPrefix      = false;
-    _hasTrailing    = false;
-    _hasMiddle      = false;
-    
+	const char*	end = line + length;
+	const char*	pos = line;
+	Token		empty = {0, 0};
+
+	_tags = empty;
+	_prefix = empty;
+	_trailing = empty;
+
+	/* Seperate IRCv3 message tags from message */
+	if (pos < end && *pos == '@')
+	{
+		const char* start = ++pos;
+		while (pos < end && *pos != ' ')
+			++pos;
+		_tags.offset = start - line;
+		_tags.length = pos - start;
+		while (pos < end && *pos == ' ')
+			++pos;
+	}
+
 	/* Seperate prefix from message */
-    if (raw.at(0) == ':')
-    {
-        pos = raw.find(' ');
-        _prefix = raw.substr(1, pos);
-        raw.erase(0, pos + 1);
-        _hasPrefix = true;
-    }
-
-    /* Seperate trailing string from message */
-    if ((pos = raw.find(" :")) != std::string::npos)
-    {
-        _trailing = raw.substr(pos + 2, raw.size());
-        raw = raw.substr(0, pos + 2);
-
-        if ((pos = _trailing.find("\r\n")) != std::string::npos)
-            _trailing = _trailing.substr(0, pos);
-        _hasTrailing = true;
-    }
-
-	/* Seperate the middle parameters into a vector of strings */
-    while ((pos = raw.find(' ')) != std::string::npos || (pos = raw.find("\r\n")) != std::string::npos)
-    {
-        _middle.push_back(raw.substr(0, pos));
-        raw.erase(0, pos + 1);
-    }
-	
-    /* Remove command from middle, and transform to lower case for key matching with _commands map */
-    if (getMiddle().empty() == false)
-    {
-	    _cmd = _middle.at(0);
-        _middle.erase(_middle.begin());
-	    std::transform(_cmd.begin(), _cmd.end(), _cmd.begin(), ::tolower);
-    }
-
-    /* Check if any other parameters remain in middle */
-    if (!_middle.empty())
-        _hasMiddle = true;
+	if (pos < end && *pos == ':')
+	{
+		const char* start = ++pos;
+		while (pos < end && *pos != ' ')
+			++pos;
+		_prefix.offset = start - line;
+		_prefix.length = pos - start;
+		_hasPrefix = true;
+	}
+
+	/* Command, resolved case-insensitively */
+	while (pos < end && *pos == ' ')
+		++pos;
+	const char* command = pos;
+	while (pos < end && *pos != ' ')
+		++pos;
+	_cmd.offset = command - line;
+	_cmd.length = pos - command;
+	_cmdId = CommandTable::lookup(command, _cmd.length);
+
+	/* Middle parameters until a ':' or the last allowed parameter, which start the trailing */
+	for (;;)
+	{
+		while (pos < end && *pos == ' ')
+			++pos;
+		if (pos == end)
+			break;
+		if (*pos == ':' || _nbMiddle == MAX_PARAMS - 1)
+		{
+			pos += (*pos == ':');
+			_trailing.offset = pos - line;
+			_trailing.length = end - pos;
+			_hasTrailing = true;
+			break;
+		}
+		const char* start = pos;
+		while (pos < end && *pos != ' ')
+			++pos;
+		_middle[_nbMiddle].offset = start - line;
+		_middle[_nbMiddle].length = pos - start;
+		++_nbMiddle;
+	}
+}
+
+StringView	Message::getMiddle(size_t index) const {
+	if (index >= _nbMiddle)
+		return StringView();
+	return _view(_middle[index]);
+}
+
+bool	Message::getTag(const char* key, StringView& value) const {
+	const char*	pos = _line + _tags.offset;
+	const char*	end = pos + _tags.length;
+	size_t		keyLength = std::strlen(key);
+
+	while (pos < end)
+	{
+		const char* next = static_cast<const char*>(std::memchr(pos, ';', end - pos));
+		if (!next)
+			next = end;
+		const char* equal = static_cast<const char*>(std::memchr(pos, '=', next - pos));
+		const char* keyEnd = equal ? equal : next;
+
+		if (static_cast<size_t>(keyEnd - pos) == keyLength && std::memcmp(pos, key, keyLength) == 0)
+		{
+			value = equal ? StringView(equal + 1, next - equal - 1) : StringView();
+			return true;
+		}
+		pos = next + 1;
+	}
+	return false;
 }
@@ -0,0 +1,157 @@
+/* Local Includes */
+#include "NickIndex.hpp"
+#include "Client.hpp"
+
+/* System Includes */
+#include <algorithm>
+#include <ctime>
+#include <fcntl.h>
+#include <unistd.h>
+
+/* RFC 1459 lower case: "[\]^" follow "Z" as "{|}~" follow "z" */
+static inline unsigned char fold(char c) {
+	unsigned char byte = static_cast< unsigned char >(c);
+	return (byte >= 'A' && byte <= '^') ? byte + ('a' - 'A') : byte;
+}
+
+static inline uint64_t rotl(uint64_t x, int b) { return (x << b) | (x >> (64 - b)); }
+
+static inline void sipRound(uint64_t& v0, uint64_t& v1, uint64_t& v2, uint64_t& v3) {
+	v0 += v1; v1 = rotl(v1, 13); v1 ^= v0; v0 = rotl(v0, 32);
+	v2 += v3; v3 = rotl(v3, 16); v3 ^= v2;
+	v0 += v3; v3 = rotl(v3, 21); v3 ^= v0;
+	v2 += v1; v1 = rotl(v1, 17); v1 ^= v2; v2 = rotl(v2, 32);
+}
+
+/*****************************/
+/*        Constructor        */
+/*****************************/
+
+NickIndex::NickIndex( ) : _slots(64), _count(0) {
+	Slot empty = {NULL, 0};
+	std::fill(_slots.begin( ), _slots.end( ), empty);
+
+	/* Fall back on a weaker seed if the kernel's entropy is unavailable */
+	int fd = open("/dev/urandom", O_RDONLY);
+	if (fd < 0 || ::read(fd, _seed, sizeof(_seed)) != sizeof(_seed)) {
+		_seed[0] = static_cast< uint64_t >(std::time(NULL)) ^ reinterpret_cast< uintptr_t >(this);
+		_seed[1] = static_cast< uint64_t >(getpid( )) * 0x9E3779B97F4A7C15ULL;
+	}
+	if (fd >= 0)
+		close(fd);
+}
+
+/*****************************/
+/*      Member Functions     */
+/*****************************/
+
+Client* NickIndex::find(const std::string& nick) const {
+	size_t slot = _findSlot(nick, _hash(nick));
+	return _slots[slot].client;
+}
+
+void NickIndex::insert(Client* client) {
+	const std::string& nick = client->getNickname( );
+	uint64_t           hash = _hash(nick);
+	size_t             slot = _findSlot(nick, hash);
+
+	if (_slots[slot].client)
+		return;
+	_slots[slot].client = client;
+	_slots[slot].hash   = hash;
+	if (++_count * 2 > _slots.size( ))
+		_grow( );
+}
+
+/* Backward shift deletion: later entries of the probe sequence move up, no tombstones */
+void NickIndex::erase(Client* client) {
+	const std::string& nick = client->getNickname( );
+	size_t             mask = _slots.size( ) - 1;
+	size_t             hole = _findSlot(nick, _hash(nick));
+
+	if (_slots[hole].client != client)
+		return;
+	for (size_t next = (hole + 1) & mask; _slots[next].client; next = (next + 1) & mask) {
+		size_t home = _slots[next].hash & mask;
+		/* Move the entry if the hole lies between its home slot and where it sits */
+		if (((next - home) & mask) >= ((next - hole) & mask)) {
+			_slots[hole] = _slots[next];
+			hole         = next;
+		}
+	}
+	_slots[hole].client = NULL;
+	--_count;
+}
+
+bool NickIndex::equals(const std::string& lhs, const std::string& rhs) {
+	if (lhs.size( ) != rhs.size( ))
+		return false;
+	for (size_t i = 0; i < lhs.size( ); ++i)
+		if (fold(lhs[i]) != fold(rhs[i]))
+			return false;
+	return true;
+}
+
+/*****************************/
+/*  Private Member Functions */
+/*****************************/
+
+/* SipHash-1-3 of the case-folded nickname */
+uint64_t NickIndex::_hash(const std::string& nick) const {
+	uint64_t v0   = _seed[0] ^ 0x736f6d6570736575ULL;
+	uint64_t v1   = _seed[1] ^ 0x646f72616e646f6dULL;
+	uint64_t v2   = _seed[0] ^ 0x6c7967656e657261ULL;
+	uint64_t v3   = _seed[1] ^ 0x7465646279746573ULL;
+	size_t   size = nick.size( );
+	uint64_t word = 0;
+	size_t   i    = 0;
+
+	for (; i < size; ++i) {
+		word |= static_cast< uint64_t >(fold(nick[i])) << (8 * (i & 7));
+		if ((i & 7) == 7) {
+			v3 ^= word;
+			sipRound(v0, v1, v2, v3);
+			v0 ^= word;
+			word = 0;
+		}
+	}
+	word |= static_cast< uint64_t >(size) << 56;
+	v3 ^= word;
+	sipRound(v0, v1, v2, v3);
+	v0 ^= word;
+
+	v2 ^= 0xff;
+	sipRound(v0, v1, v2, v3);
+	sipRound(v0, v1, v2, v3);
+	sipRound(v0, v1, v2, v3);
+	return v0 ^ v1 ^ v2 ^ v3;
+}
+
+/* Slot holding the nickname, or the free slot ending its probe sequence */
+size_t NickIndex::_findSlot(const std::string& nick, uint64_t hash) const {
+	size_t mask = _slots.size( ) - 1;
+	size_t slot = hash & mask;
+
+	while (_slots[slot].client
+	       && (_slots[slot].hash != hash || !equals(_slots[slot].client->getNickname( ), nick)))
+		slot = (slot + 1) & mask;
+	return slot;
+}
+
+void NickIndex::_grow( ) {
+	std::vector<Slot> old(_slots.size( ) * 2);
+	Slot              empty = {NULL, 0};
+
+	std::fill(old.begin( ), old.end( ), empty);
+	old.swap(_slots);
+
+	size_t mask = _slots.size( ) - 1;
+	for (size_t i = 0; i < old.size( ); ++i) {
+		if (!old[i].client)
+			continue;
+		size_t slot = old[i].hash & mask;
+		while (_slots[slot].client)
+			slot = (slot + 1) & mask;
+		_slots[slot] = old[i];
+	}
+}
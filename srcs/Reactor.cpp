@@ -0,0 +1,34 @@
+/* Local Includes */
+#include "Reactor.hpp"
+#include "reactors/EpollReactor.hpp"
+#include "reactors/PollReactor.hpp"
+#include "reactors/UringReactor.hpp"
+
+/* System Includes */
+#include <exception>
+
+/* Build the requested backend. Backends missing at compile or run time fall back on
+ * the next one in order: io_uring, epoll, poll */
+Reactor* Reactor::create(const std::string& backend) {
+	if (backend == "poll")
+		return new PollReactor( );
+#ifdef HAS_IO_URING
+	if (backend == "io_uring") {
+		try {
+			return new UringReactor( );
+		}
+		catch (const std::exception&) {
+			/* Kernel without (recent enough) io_uring, try epoll instead */
+		}
+	}
+#endif
+#ifdef __linux__
+	try {
+		return new EpollReactor( );
+	}
+	catch (const std::exception&) {
+		/* epoll unavailable (e.g. seccomp filtered), use poll() instead */
+	}
+#endif
+	return new PollReactor( );
+}
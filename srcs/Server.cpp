@@ -1,11 +1,14 @@
 /* Local Includes */
 #include "Server.hpp"
 #include "Client.hpp"
+#include "Clock.hpp"
+#include "Logger.hpp"
 #include "defines.h"
 #include "replies.h"
 
 /* Command Includes */
 #include "commands/Away.hpp"
+#include "commands/Cap.hpp"
 #include "commands/Invite.hpp"
 #include "commands/Join.hpp"
 #include "commands/Kick.hpp"
@@ -22,6 +25,7 @@
 #include "commands/Quit.hpp"
 #include "commands/Shutdown.hpp"
 #include "commands/Topic.hpp"
+#include "commands/TraceDump.hpp"
 #include "commands/User.hpp"
 #include "commands/Who.hpp"
 #include "commands/Whois.hpp"
@@ -31,46 +35,51 @@
 /* Constructor & Destructor */
 /*****************************/
 
-Server::Server(const std::string& servername, const int port, const std::string& password) :
-	_servername(servername), _password(password), _timeStart(std::time(nullptr)), _port(port) {
+Server::Server(const std::string& servername, const int port, const std::string& password, const Config& config) :
+	_servername(servername), _password(password), _timeStart(Clock::wall()), _config(config), _port(port), _nextLoop(0), _lastTraceDump(0), _nbClients(0) {
 	/* Attempt to initialize server */
 	try
 	{
 		/* Setup server connection */
 		initializeConnection();
-		std::cout << getTimestamp() << GREEN "Server initialization successful" CLEAR << std::endl;
-		std::cout << "\t\t\t\tport: " << port << std::endl << "\t\t\t\tpass: " << password << std::endl;
+		LOG(SERVER, INFO, GREEN "Server initialization successful" CLEAR "\n\t\t\t\tport: " << port << "\n\t\t\t\tpass: " << password
+			<< "\n\t\t\t\tevent loop: " << _loops[0]->getBackendName() << " x " << _loops.size());
+		if (_config.reactor != _loops[0]->getBackendName())
+			LOG(SERVER, WARN, YELLOW "Event loop backend '" << _config.reactor << "' unavailable, using " << _loops[0]->getBackendName() << CLEAR);
 		
 		/* Initialize commands map */
 		initializeCommands();
-		std::cout << getTimestamp() << GREEN "Command initialization successful" CLEAR<< std::endl;
+		LOG(SERVER, INFO, GREEN "Command initialization successful" CLEAR);
 	}
 	catch(const std::exception& e)
 	{
-		std::cerr << e.what() << '\n';
-		std::cerr << RED "Failure to initialize server, program exiting" CLEAR << std::endl;
-		shutdown(_socket, SHUT_RDWR);
+		LOG(SERVER, ERROR, e.what() << "\n" RED "Failure to initialize server, program exiting" CLEAR);
+		for (size_t i = 0; i < _sockets.size(); i++)
+			shutdown(_sockets[i], SHUT_RDWR);
+		Logger::stop();
 		exit (1);
 	}
 
 	/* Start Server Loop */
-	std::cout << "_______________________________________________________" << std::endl << std::endl;
-	std::cout << getTimestamp() <<  "Server status - " << GREEN "ONLINE" CLEAR << std::endl;
-	std::cout << "_______________________________________________________" << std::endl << std::endl;
+	LOG(SERVER, INFO, "Server status - " GREEN "ONLINE" CLEAR "\n_______________________________________________________\n");
 	runServer();
 }
 
 Server::~Server() {
+	/* Delete event loops, joining their threads */
+	for (size_t i = 0; i < _loops.size(); i++)
+		delete (_loops[i]);
+	_loops.clear();
+
 	/* Delete Commands*/
-	std::map<std::string, Command *>::iterator it = _commands.begin();
-	for (; it != _commands.end(); ++it)
-		delete (it->second);
-	_commands.clear();
+	for (size_t i = 0; i < CommandTable::COUNT; i++)
+		delete (_commands[i]);
 
 	/* Delete Clients */
 	for (size_t i = 0; i < _clients.size(); i++)
 		delete (_clients[i]);
 	_clients.clear();
+	_nbClients = 0;
 	
 	/* Delete channels */
 	std::map<std::string, Channel *>::iterator it_ch = _channels.begin();
@@ -78,8 +87,12 @@ Server::~Server() {
 		delete (it_ch->second);
 	_channels.clear();
 
-	/* Close server socket */
-	shutdown(_socket, SHUT_RDWR);
+	/* Close server sockets */
+	for (size_t i = 0; i < _sockets.size(); i++)
+	{
+		shutdown(_sockets[i], SHUT_RDWR);
+		close(_sockets[i]);
+	}
 }
 
 
@@ -87,33 +100,21 @@ Server::~Server() {
 /*      Server Initialization      */
 /***********************************/
 
-/* Open server socket and configure for listening */
+/* Open server sockets and configure for listening */
 void		Server::initializeConnection(void) {
-	int	yes = 1;
-
-	/* Create socket */
-	if ((_socket  = socket(AF_INET, SOCK_STREAM, 0)) < 0)
-		throw std::runtime_error("Unable to create socket");
-
-	/* Set socket as non-blocking */
-	fcntl(_socket, F_SETFL, O_NONBLOCK);
-
-	/* Set socket options to reuse addresses */
-	if (setsockopt(_socket, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(int)) < 0)
-		throw std::runtime_error("Unable to set socket options");
-
 	/* Setup socket address struct */
 	_address.sin_port = htons(_port);
 	_address.sin_family = AF_INET;
 	_address.sin_addr.s_addr = INADDR_ANY;
 
-	/* Bind Socket */
-	if (bind(_socket, (struct sockaddr *)&_address, sizeof(_address)) < 0)
-		throw std::runtime_error("Unable to bind socket");
-	
-	/* Set socket to passive listening */
-	if (listen(_socket, MAX_CONNECTIONS) < 0)
-		throw std::runtime_error("Unable to listen on socket");
+	/* On Linux, SO_REUSEPORT lets the kernel spread connections over one listener per loop */
+	bool	sharded = false;
+#if defined(__linux__) && defined(SO_REUSEPORT)
+	sharded = _config.threads > 1;
+#endif
+	size_t	nbListeners = sharded ? _config.threads : 1;
+	for (size_t i = 0; i < nbListeners; i++)
+		_openListener(sharded);
 	
 	/* Get server hostname & IP */
 	char hostname[1024];
@@ -127,33 +128,73 @@ void		Server::initializeConnection(void) {
 	/* Set Server Status */
 	g_status = ONLINE;
 
-	/* Set up pollFDs */
-	pollfd pfd = {.fd = _socket, .events = POLLIN, .revents = 0};
-	_pfds.push_back(pfd);
+	/* Set up event loops, the first one runs on the main thread. Without sharding it
+	 * owns the only listener and spreads new clients over the other loops */
+	for (size_t i = 0; i < _config.threads; i++)
+		_loops.push_back(new EventLoop(this, i, _config.reactor, _config.cpuForLoop(i)));
+	for (size_t i = 0; i < _sockets.size(); i++)
+		_loops[i]->listen(_sockets[i]);
+}
+
+/* Add a non-blocking socket listening on the server port to _sockets */
+void		Server::_openListener(bool reusePort) {
+	int	fd;
+	int	yes = 1;
+
+	/* Create socket */
+	if ((fd = socket(AF_INET, SOCK_STREAM, 0)) < 0)
+		throw std::runtime_error("Unable to create socket");
+	_sockets.push_back(fd);
+
+	/* Set socket as non-blocking, and keep it from leaking into child processes */
+	fcntl(fd, F_SETFL, O_NONBLOCK);
+	fcntl(fd, F_SETFD, FD_CLOEXEC);
+
+	/* Set socket options to reuse addresses */
+	if (setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(int)) < 0)
+		throw std::runtime_error("Unable to set socket options");
+#ifdef SO_REUSEPORT
+	if (reusePort && setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &yes, sizeof(int)) < 0)
+		throw std::runtime_error("Unable to set socket options");
+#else
+	(void)reusePort;
+#endif
+
+	/* Bind Socket */
+	if (bind(fd, (struct sockaddr *)&_address, sizeof(_address)) < 0)
+		throw std::runtime_error("Unable to bind socket");
+	
+	/* Set socket to passive listening */
+	if (listen(fd, MAX_CONNECTIONS) < 0)
+		throw std::runtime_error("Unable to listen on socket");
 }
 
 /* Build Server Commands */
 void		Server::initializeCommands(void) {
-	_commands["away"] = new Away(this);
-	_commands["invite"] = new Invite(this);
-	_commands["join"] = new Join(this);
-	_commands["kick"] = new Kick(this);
-	_commands["list"] = new List(this);
-	_commands["mode"] = new Mode(this);
-	_commands["names"] = new Names(this);
-	_commands["nick"] = new Nick(this);
-	_commands["notice"] = new Notice(this);
-	_commands["part"] = new Part(this);
-	_commands["pass"] = new Pass(this);
-	_commands["ping"] = new Ping(this);
-	_commands["pong"] = new Pong(this);
-	_commands["privmsg"] = new Privmsg(this);
-	_commands["quit"] = new Quit(this);
-	_commands["shutdown"] = new Shutdown(this);
-	_commands["topic"] = new Topic(this);
-	_commands["user"] = new User(this);
-	_commands["who"] = new Who(this);
-	_commands["whois"] = new Whois(this);
+	/* Unknown commands have no handler */
+	std::fill(_commands, _commands + CommandTable::COUNT, static_cast<Command *>(NULL));
+	_commands[CommandTable::AWAY] = new Away(this);
+	_commands[CommandTable::CAP] = new Cap(this);
+	_commands[CommandTable::INVITE] = new Invite(this);
+	_commands[CommandTable::JOIN] = new Join(this);
+	_commands[CommandTable::KICK] = new Kick(this);
+	_commands[CommandTable::LIST] = new List(this);
+	_commands[CommandTable::MODE] = new Mode(this);
+	_commands[CommandTable::NAMES] = new Names(this);
+	_commands[CommandTable::NICK] = new Nick(this);
+	_commands[CommandTable::NOTICE] = new Notice(this);
+	_commands[CommandTable::PART] = new Part(this);
+	_commands[CommandTable::PASS] = new Pass(this);
+	_commands[CommandTable::PING] = new Ping(this);
+	_commands[CommandTable::PONG] = new Pong(this);
+	_commands[CommandTable::PRIVMSG] = new Privmsg(this);
+	_commands[CommandTable::QUIT] = new Quit(this);
+	_commands[CommandTable::SHUTDOWN] = new Shutdown(this);
+	_commands[CommandTable::TOPIC] = new Topic(this);
+	_commands[CommandTable::TRACEDUMP] = new TraceDump(this);
+	_commands[CommandTable::USER] = new User(this);
+	_commands[CommandTable::WHO] = new Who(this);
+	_commands[CommandTable::WHOIS] = new Whois(this);
 }
 
 
@@ -161,162 +202,314 @@ void		Server::initializeCommands(void) {
 /*      Server Operation Functions      */
 /****************************************/
 
-/* Manage Connection Requests from New Clients */
-void		Server::handleConnections() {
-	/* Setup variables to manage connection */
-	std::cout << getTimestamp() << RED "Incoming connection request" CLEAR<< std::endl;
-	int	new_fd;
-	int	addressLen;
-	struct sockaddr_in clientAddress;
-	addressLen = sizeof(clientAddress);
-
-	/* Attempt to connect to client and get client address info*/
-	if ((new_fd = accept(_socket, (struct sockaddr *)&clientAddress, (socklen_t *)&addressLen)) < 0)
-		throw std::runtime_error("Failure to accept incoming connection due to socket error");
-	
-	/* Set socket option to ensure that we dont attempt to send on a socket that has been disconnected */
-	int yes = 1;
-	if (setsockopt(new_fd, SOL_SOCKET, SO_NOSIGPIPE, &yes, sizeof(int)) < 0)
-		throw std::runtime_error("Unable to set socket options");
+/* Accept a connection as a non-blocking, close-on-exec socket */
+static int	acceptClient(int listenFd, struct sockaddr_in* address) {
+	socklen_t	addressLen = sizeof(*address);
+#ifdef __linux__
+	return accept4(listenFd, (struct sockaddr *)address, &addressLen, SOCK_NONBLOCK | SOCK_CLOEXEC);
+#else
+	int	fd = accept(listenFd, (struct sockaddr *)address, &addressLen);
+	if (fd >= 0)
+	{
+		fcntl(fd, F_SETFL, O_NONBLOCK);
+		fcntl(fd, F_SETFD, FD_CLOEXEC);
+	}
+	return (fd);
+#endif
+}
 
-	/* Add client to _clients map and populate address variables */
-	_clients.push_back(new Client(new_fd));
-	_clients.back()->setAddress(clientAddress);
-	_clients.back()->setHostname(inet_ntoa(clientAddress.sin_addr));
+/* Manage Connection Requests from New Clients, at most ACCEPT_BATCH per loop iteration. The
+ * listener stays readable while more are waiting in its backlog. */
+void		Server::handleConnections(EventLoop* loop, int listenFd) {
+	std::vector<std::pair<int, struct sockaddr_in> >	accepted;
+	struct sockaddr_in									clientAddress;
+	int													new_fd;
 
-	/* Create new pollfd object and add to _pfds list */
-	pollfd pfd = {.fd = new_fd, .events = POLLIN, .revents = 0};
-	_pfds.push_back(pfd);
+	/* Attempt to connect to every pending client and get client address info */
+	while (accepted.size() < ACCEPT_BATCH
+	       && ((new_fd = acceptClient(listenFd, &clientAddress)) >= 0 || errno == EINTR || errno == ECONNABORTED))
+	{
+		if (new_fd < 0)
+			continue;
+		LOG(CONNECTIONS, INFO, RED "Incoming connection request" CLEAR);
+		loop->getTrace().record(Trace::ACCEPT, new_fd, 0);
+#ifdef SO_NOSIGPIPE
+		/* Set socket option to ensure that we dont attempt to send on a socket that has been disconnected */
+		int yes = 1;
+		if (setsockopt(new_fd, SOL_SOCKET, SO_NOSIGPIPE, &yes, sizeof(int)) < 0)
+		{
+			close(new_fd);
+			continue;
+		}
+#endif
+		accepted.push_back(std::make_pair(new_fd, clientAddress));
+	}
+	if (accepted.size() < ACCEPT_BATCH)
+		_acceptFailed(loop, errno);
+	_registerClients(loop, accepted);
+}
 
-	/* Print new client data */
-	std::cout << getTimestamp() << GREEN "New client connected successfully" CLEAR << std::endl;
-	std::cout << "\t\t\t\taddress: " << inet_ntoa(clientAddress.sin_addr) <<  std::endl;
+/* Register connections the reactor accepted itself, negative entries are accept errors */
+void		Server::handleAccepted(EventLoop* loop, const std::vector<int>& sockets) {
+	std::vector<std::pair<int, struct sockaddr_in> >	accepted;
+	struct sockaddr_in									clientAddress;
+	socklen_t											addressLen;
+
+	for (size_t i = 0; i < sockets.size(); i++)
+	{
+		if (sockets[i] < 0)
+		{
+			_acceptFailed(loop, -sockets[i]);
+			continue;
+		}
+		LOG(CONNECTIONS, INFO, RED "Incoming connection request" CLEAR);
+		loop->getTrace().record(Trace::ACCEPT, sockets[i], 0);
+		/* The address is only needed once, it is not worth a buffer per accept in the ring */
+		addressLen = sizeof(clientAddress);
+		if (getpeername(sockets[i], (struct sockaddr *)&clientAddress, &addressLen) < 0)
+		{
+			close(sockets[i]);
+			continue;
+		}
+		accepted.push_back(std::make_pair(sockets[i], clientAddress));
+	}
+	_registerClients(loop, accepted);
+}
+
+/* Report why accept() stopped. Out of resources, the loop stops accepting for a while instead
+ * of spinning on a listener that stays readable. */
+void		Server::_acceptFailed(EventLoop* loop, int error) {
+	if (error == EMFILE || error == ENFILE || error == ENOBUFS || error == ENOMEM)
+	{
+		LOG(CONNECTIONS, WARN, YELLOW "Unable to accept incoming connections: " << strerror(error)
+				  << ", retrying in " << ACCEPT_BACKOFF << " ms" CLEAR);
+		loop->pauseAccept();
+	}
+	else if (error != EAGAIN && error != EWOULDBLOCK && error != EINTR && error != ECONNABORTED)
+		LOG(CONNECTIONS, ERROR, RED "Failure to accept incoming connection: " << strerror(error) << CLEAR);
+}
+
+/* Register a batch of accepted connections at once */
+void		Server::_registerClients(EventLoop* loop, const std::vector<std::pair<int, struct sockaddr_in> >& accepted) {
+	if (accepted.empty())
+		return;
+
+	ScopedLock lock(_lock);
+	for (size_t i = 0; i < accepted.size(); i++)
+	{
+		/* Add client to the _clients table and populate address variables */
+		Client* client = new Client(accepted[i].first);
+		if ((size_t)client->getSocket() >= _clients.size())
+			_clients.resize(client->getSocket() + 1, nullptr);
+		_clients[client->getSocket()] = client;
+		_nbClients++;
+		client->setAddress(accepted[i].second);
+		client->setHostname(inet_ntoa(accepted[i].second.sin_addr));
+		client->setSendQLimits(_config.sendqUnregistered, _config.sendqRegistered);
+
+		/* Sharded listeners keep their clients, a single listener assigns them round-robin */
+		EventLoop* owner = (_sockets.size() > 1) ? loop : _loops[_nextLoop++ % _loops.size()];
+		client->setLoop(owner);
+		if (owner == loop)
+			owner->watch(client);
+		else
+			owner->adopt(client);
+
+		/* Print new client data */
+		LOG(CONNECTIONS, INFO, GREEN "New client connected successfully" CLEAR "\n\t\t\t\taddress: " << client->getHostname());
+	}
 }
 
-/* Read incoming data from client socket & perform actions */
-void		Server::handleMessages(Client* client)
+/* Perform actions for data read from client socket, called with the server lock held */
+void		Server::handleMessages(Client* client, int nbytes)
 {	
-	std::string	rawMessage;
-	std::string	cmd;
-	/* Client reads entire input string coming from their socket */
-	if (client->read() <= 0)
+	const char*	line;
+	size_t		length;
+	CommandTable::Id	cmd;
+	/* Client has already read the input coming from their socket */
+	if (nbytes <= 0)
 	{
 		/* Handle forcefully disconnected clients */
-		std::cout << getTimestamp() << RED "Removing disconnected client: " CLEAR << client->getUsername() << std::endl;
-		std::map<std::string, Channel*>::iterator it = _channels.begin();
-		for (; it != _channels.end(); ++it)
-		{
-			if (it->second->isMember(client))
-				it->second->sendToOthers(CMD_QUIT(client->getNickname(), client->getUsername(), client->getAddress()), client);
-		}
+		LOG(CONNECTIONS, INFO, RED "Removing disconnected client: " CLEAR << client->getUsername());
+		const std::vector<Channel*>& channels = client->getChannels();
+		for (size_t i = 0; i < channels.size(); ++i)
+			channels[i]->sendToOthers(CMD_QUIT(client->getNickname(), client->getUsername(), client->getAddress()), client);
 		removeClient(client);
 	}
 	else
 	{
-		rawMessage = client->retrieveMessage();
-		/* While there are valid commands (messages) stored in the client's input string */
-		while (rawMessage.empty() == false)
+		client->getLoop()->getTrace().record(Trace::READ, client->getSocket(), nbytes);
+		client->setLastActivityTime(Clock::wall());
+		client->setLastActivityMs(Clock::monotonic());
+		/* While there are complete lines stored in the client's input buffer */
+		Client::LineStatus status;
+		while ((status = client->nextLine(line, length)) != Client::NO_LINE)
 		{
-			/* Build message from rawMessage */
-			Message	msg(client, rawMessage);
-			cmd = msg.getCommand();
+			if (status == Client::LINE_TOO_LONG)
+			{
+				client->reply(ERR_INPUTTOOLONG(_hostname, client->getNickname()));
+				continue;
+			}
+			/* Message tags without a command, silently ignored */
+			if (status == Client::LINE_MALFORMED)
+				continue;
+
+			/* Build message from the line */
+			Message	msg(client, line, length);
+			client->getLoop()->getStats().commands++;
+			cmd = msg.getCommandId();
 
-			/* If message is cap, do nothing */
-			if (cmd != "cap")
+			/* If password has not been verified and command is not pass or cap, terminate connection */
+			if (!client->getPassStatus() && cmd != CommandTable::PASS && cmd != CommandTable::CAP)
 			{
-				/* If password has not been verified and command is not pass, terminate connection */
-				if (!client->getPassStatus() && cmd != "pass")
-				{
+				client->reply("ERROR :Closing Link: localhost (Bad Password)\n");
+				removeClient(client);
+				break;
+			}
+			/* If client is not registered and tries to run a non-registration command send error */
+			else if (!client->getRegistration() && CommandTable::info(cmd).registered)
+				client->reply(ERR_NOTREGISTERED(_hostname));
+			else
+			{
+				try {
+					executeCommand(msg);
+				}
+				catch (Pass::passException& e) {
 					client->reply("ERROR :Closing Link: localhost (Bad Password)\n");
 					removeClient(client);
 					break;
 				}
-				/* If client is not registered and tries to run a non-registration command send error */
-				else if (!client->getRegistration() && cmd != "pass" && cmd != "nick" && cmd != "user")
-					client->reply(ERR_NOTREGISTERED(_hostname));
-				else
-				{
-					try {
-						executeCommand(msg);
-					}
-					catch (Pass::passException& e) {
-						client->reply("ERROR :Closing Link: localhost (Bad Password)\n");
-						removeClient(client);
-						break;
-					}
-					catch (...) {
-						std::cerr << getTimestamp() << YELLOW "Caught unknown exception" CLEAR << std::endl;
-					}
+				catch (...) {
+					LOG(COMMANDS, WARN, YELLOW "Caught unknown exception" CLEAR);
 				}
 			}
 
-			/* Retrieve next command */
-			rawMessage = client->retrieveMessage();	
+			/* Stop once the client has been removed, e.g. by QUIT */
+			if (client->isClosing())
+				break;
 		}
 	}
 }
 
 /* Execute a command from client */
 void		Server::executeCommand(const Message & msg) {
-	/* Attempt to execute command */
-	try
-	{
-		_commands.at(msg.getCommand())->execute(msg);
-	}
+	uint64_t	start = Trace::now();
+	uint8_t		id = 0;
+
+	Command*	command = _commands[msg.getCommandId()];
+
 	/* Error message if command is invalid or not supported */
-	catch(std::out_of_range &e)
+	if (!command)
+		msg._client->reply(ERR_UNKNOWNCOMMAND(_hostname, msg._client->getNickname(), msg.getCommand().str()));
+	/* Parameter count is checked here once for every command */
+	else if (msg.getMiddleCount() < CommandTable::info(msg.getCommandId()).minParams)
+		msg._client->reply(ERR_NEEDMOREPARAMS(_hostname, msg._client->getNickname(), msg.getCommand().str()));
+	/* Attempt to execute command */
+	else
 	{
-		msg._client->reply(ERR_UNKNOWNCOMMAND(_hostname, msg._client->getNickname(), msg.getCommand()));
+		id = command->getId();
+		command->execute(msg);
 	}
+	uint64_t elapsed = Trace::now() - start;
+	msg._client->getLoop()->getTrace().record(Trace::DISPATCH, msg._client->getSocket(), std::min<uint64_t>(elapsed, 0xFFFFFFFF), id);
 }
 
 /* Main server loop */
 void		Server::runServer(void) {
-	while (g_status == ONLINE)
+	sigset_t	sigint;
+	sigset_t	oldMask;
+
+	/* Extra loops get their own threads, with SIGINT and SIGUSR1 blocked so that they reach the main thread */
+	sigemptyset(&sigint);
+	sigaddset(&sigint, SIGINT);
+	sigaddset(&sigint, SIGUSR1);
+	pthread_sigmask(SIG_BLOCK, &sigint, &oldMask);
+	for (size_t i = 1; i < _loops.size(); i++)
+		_loops[i]->start();
+	pthread_sigmask(SIG_SETMASK, &oldMask, NULL);
+
+	/* The first loop runs on the main thread */
+	try {
+		_loops[0]->run();
+	}
+	catch (...) {
+		g_status = OFFLINE;
+		wakeLoops();
+		for (size_t i = 1; i < _loops.size(); i++)
+			_loops[i]->join();
+		throw;
+	}
+
+	/* Wait for the other loops to wind down */
+	wakeLoops();
+	for (size_t i = 1; i < _loops.size(); i++)
+		_loops[i]->join();
+
+	for (size_t i = 0; i < _loops.size(); i++)
+		_loops[i]->logStats();
+}
+
+/* A client's timer fired: enforce the registration deadline, then ping the client once it
+ * has been idle for PING_INTERVAL and drop it if it stays silent for PING_TIMEOUT */
+void		Server::handleTimeout(Client* client, uint64_t now) {
+	uint64_t idle = now - client->getLastActivityMs();
+
+	if (!client->getRegistration())
+		return dropClient(client, "Registration timeout");
+
+	if (client->getPingStatus())
 	{
-		/* Poll all open sockets for activity */
-		if (poll(_pfds.data(), _pfds.size(), 10) < 0) {
-			if (g_status == OFFLINE)	// If server is terminated through SIGINT, poll will fail
-				return ;
-			throw std::runtime_error("Error when attempting to poll");
-		}
-			
-		/* Iterate through sockets to check for events */
-		for (size_t i = 0; i < _pfds.size(); i++)
-		{
-			/* If there is an event is on the server socket, check for new connection */
-			if (i == 0 && (_pfds[i].revents & POLLIN))
-					handleConnections();
-			else if (i > 0)
-			{
-				Client* client = _clients[i - 1];
-				/* If there is an event on a client socket, get input */
-				if (_pfds[i].revents & POLLIN)
-					handleMessages(client);
-				/* If there is no event, check if ping interval has passed and send PING to */
-				else
-				{
-					if (client->getRegistration() && !client->getPingStatus() && 
-						((std::time(nullptr) - client->getLastActivityTime()) > PING_INTERVAL))
-					{
-						client->reply(CMD_PING(_hostname, std::to_string(std::time(nullptr))));
-						client->setPingStatus(true);
-					}
-				}
-			}
-		}
+		if (idle >= PING_TIMEOUT * 1000)
+			return dropClient(client, "Ping timeout");
+		/* Any activity since the PING proves the client is alive */
+		client->setPingStatus(false);
+	}
+	else if (idle >= PING_INTERVAL * 1000)
+	{
+		client->reply(CMD_PING(_hostname, std::to_string(Clock::wall())));
+		client->setPingStatus(true);
+		client->getLoop()->schedule(client, now + PING_TIMEOUT * 1000);
+		return;
 	}
+	client->getLoop()->schedule(client, client->getLastActivityMs() + PING_INTERVAL * 1000);
 }
 
 /* Stop server and send shutdown message to all clients */
 void		Server::stopServer(void) {
-	g_status = OFFLINE;
 	std::vector<Client*>::iterator it = _clients.begin();
 	for (; it != _clients.end(); ++it)
 	{
-	Client* client = *it;
-	client->reply(ERR_SHUTDOWN(client->getUsername(), client->getAddress()));
+		Client* client = *it;
+		if (client)
+			client->reply(ERR_SHUTDOWN(client->getUsername(), client->getAddress()));
+	}
+
+	/* Only once the notices are posted, or a loop could exit before they reach its mailbox */
+	g_status = OFFLINE;
+	wakeLoops();
+}
+
+/* Have every loop dump its flight recorder, they each write their own at the end of their iteration */
+bool		Server::dumpTraces(void) {
+	uint64_t	now = Clock::monotonic();
+	uint64_t	last = _lastTraceDump;
+
+	/* Every loop writes its whole ring when dumping, at most one dump per TRACE_DUMP_INTERVAL.
+	 * Both SIGUSR1 and TRACEDUMP end up here, from any loop. */
+	if ((last && now - last < TRACE_DUMP_INTERVAL * 1000) || !__sync_bool_compare_and_swap(&_lastTraceDump, last, now))
+	{
+		LOG(SERVER, WARN, YELLOW "Trace dump ignored, the last one is less than " << TRACE_DUMP_INTERVAL << " seconds old" CLEAR);
+		return false;
 	}
+	for (size_t i = 0; i < _loops.size(); i++)
+		_loops[i]->requestTraceDump();
+	return true;
+}
+
+/* Interrupt every loop blocked waiting for events, so that they notice a status change */
+void		Server::wakeLoops(void) {
+	for (size_t i = 0; i < _loops.size(); i++)
+		_loops[i]->wake();
 }
 
 /*******************************/
@@ -325,67 +518,66 @@ void		Server::stopServer(void) {
 
 /* Remove a client from the server */
 void		Server::removeClient(Client* client) {
+	if (client->isClosing())
+		return;
 
-	/* Remove client from all channels */
-	std::map<std::string, Channel *>::iterator it = _channels.begin();
-	while (it != _channels.end())
+	/* Remove client from its channels. The channel is dropped from the client's list even if
+	 * the channel did not know it as a member, so that the loop always ends. */
+	while (!client->getChannels().empty())
 	{
-		/* Remove ban from user to prevent stale memory pointer from remaining in _notMembers */
-		it->second->setMemberModes(client, BAN, true);
-		it->second->removeMember(client);
-		if (it->second->getIsEmpty())
-            destroyChannel(it++->first);
-		else
-			++it;
+		Channel* channel = client->getChannels().back();
+		channel->removeMember(client);
+		client->removeChannel(channel);
+		if (channel->getIsEmpty())
+			destroyChannel(channel->getName());
 	}
 
-	/* Remove client socket from pollFD vector */
-	std::vector<pollfd>::iterator it2 = _pfds.begin();
-	for (; it2 != _pfds.end(); ++it2)
-	{
-		if (it2->fd == client->getSocket())
-		{
-			_pfds.erase(it2);
-			break;
-		}
-	}
+	/* Drop bans and invites to prevent stale memory pointers from remaining in _notMembers */
+	while (!client->getFlaggedChannels().empty())
+		client->getFlaggedChannels().back()->forgetClient(client);
 
-	/* Shutdown socket & delete client */
-	std::vector<Client *>::iterator it3 = find(_clients.begin(), _clients.end(), client);
-	if (it3 != _clients.end())
-	{
-		shutdown(client->getSocket(), SHUT_RDWR);
-		_clients.erase(it3);
-	}
+	if (!client->getNickname().empty())
+		_nicks.erase(client);
+
+	/* Free the client's slot, its fd stays open until the loop deletes it so it cannot be reused yet */
+	_clients[client->getSocket()] = nullptr;
+	_nbClients--;
+
+	/* Hand the client back to its event loop, which is always the calling one */
+	client->getLoop()->discard(client);
 }
 
-/* Check if specified nickname is already in use on server */
-bool		Server::doesNickExist(const std::string nick) const {
-	std::vector<Client *>::const_iterator	it = _clients.begin();
-	std::vector<Client *>::const_iterator	ite = _clients.end();
+/* Close a client's link from the server side, letting its channels know */
+void		Server::dropClient(Client* client, const std::string& reason) {
+	LOG(CONNECTIONS, INFO, RED "Dropping client on socket #" << client->getSocket() << ": " CLEAR << reason);
+	client->reply(ERR_CLOSINGLINK(client->getUsername(), client->getAddress(), reason));
+	const std::vector<Channel*>& channels = client->getChannels();
+	for (size_t i = 0; i < channels.size(); ++i)
+		channels[i]->sendToOthers(CMD_QUIT(client->getNickname(), client->getUsername(), client->getAddress()), client);
+	removeClient(client);
+}
 
-	/* Iterate through clients list and attempt to find specified nickname */
-	while (it != ite)
-	{
-		if ((*it)->getNickname() == nick)
-			return (true);
-		++it;
-	}
-	return (false);
+/* Check if specified nickname is already in use on server, ignoring case */
+bool		Server::doesNickExist(const std::string& nick) const {
+	return (_nicks.find(nick) != nullptr);
 }
 
-/* Find and return client pointer using given nickname */
+/* Find and return client pointer using given nickname, ignoring case */
 Client*		Server::getClientPtr(const std::string &client) {
-	std::vector<Client*>::iterator it = _clients.begin();
-	/* Iterate through clients list and attempt to return pointer for given nickname */
-	for (; it != _clients.end(); ++it)
-	{
-		if ((*it)->getNickname() == client)
-			break;
-	}
-	if (it == _clients.end())
-		return (nullptr);
-	return *it;
+	return (_nicks.find(client));
+}
+
+/* Change a client's nickname, keeping the nickname index in step */
+void		Server::changeNickname(Client* client, const std::string& nick) {
+	if (!client->getNickname().empty())
+		_nicks.erase(client);
+	client->setNickname(nick);
+	_nicks.insert(client);
+
+	/* The cached NAMES replies of its channels hold the old nickname */
+	const std::vector<Channel*>& channels = client->getChannels();
+	for (size_t i = 0; i < channels.size(); ++i)
+		channels[i]->invalidateNames();
 }
 
 
@@ -398,7 +590,7 @@ void		Server::createChannel(const std::string& channel, Client* owner) {
 	/* Check if channel already exists */
 	if (!_channels.empty() && (_channels.find(channel) != _channels.end()))
 		return;
-	std::cout << getTimestamp() << GREEN "New channel created: " CLEAR << channel << std::endl << std::endl;
+	LOG(COMMANDS, INFO, GREEN "New channel created: " CLEAR << channel);
 	_channels[channel] = new Channel(channel, owner);
 }
 
@@ -408,7 +600,8 @@ void		Server::destroyChannel(const std::string& channel) {
 	std::map<std::string, Channel *>::iterator it = _channels.find(channel);
 	if (it == _channels.end())
 		return;
-	std::cout << getTimestamp() << YELLOW "Deleting channel: " << it->first << CLEAR << std::endl; 
+	LOG(COMMANDS, INFO, YELLOW "Deleting channel: " << it->first << CLEAR);
+	it->second->closeChannel();
 	delete it->second;
 	_channels.erase(it);
 }
@@ -440,17 +633,3 @@ Channel*	Server::getChannelPtr(const std::string& channel) {
 	return(it->second);
 }
 
-
-/********************************/
-/*      Utility Functions       */
-/********************************/
-
-/* Return a formatted timestamp for current time */
-const std::string	getTimestamp() {
-	std::time_t time = std::time(nullptr);
-	char output[50];
-	int len;
-	len = strftime(output, 50, "[%a %b %d %Y %X] : ", std::localtime(&time));
-	output[len] = 0;
-	return (std::string(output));
-}
@@ -0,0 +1,163 @@
+/* Local Includes */
+#include "TimerWheel.hpp"
+#include "Clock.hpp"
+
+/* System Includes */
+#include <algorithm>
+#include <climits>
+
+/*****************************/
+/* Constructor & Destructor */
+/*****************************/
+
+/* Empty list heads point to themselves */
+TimerWheel::TimerWheel( ) : _current(Clock::monotonic( ) / TICK_MS), _count(0) {
+	for (size_t level = 0; level < LEVELS; ++level)
+		for (size_t slot = 0; slot < SLOTS; ++slot)
+			_slots[level][slot]._prev = _slots[level][slot]._next = &_slots[level][slot];
+	_expired._prev = _expired._next = &_expired;
+}
+
+/* Leave the timers unlinked so their owners can outlive the wheel */
+TimerWheel::~TimerWheel( ) {
+	for (size_t level = 0; level < LEVELS; ++level)
+		for (size_t slot = 0; slot < SLOTS; ++slot)
+			while (_slots[level][slot]._next != &_slots[level][slot])
+				_unlink(*_slots[level][slot]._next);
+	while (_expired._next != &_expired)
+		_unlink(*_expired._next);
+}
+
+/***********************************/
+/*        Timer Management         */
+/***********************************/
+
+/* Arm a timer to fire at the given time, rescheduling it if it was already pending */
+void TimerWheel::schedule(Timer& timer, uint64_t when) {
+	cancel(timer);
+
+	/* Round up so the timer never fires early, and at the soonest on the next tick */
+	timer._expires = (when + TICK_MS - 1) / TICK_MS;
+	if (timer._expires <= _current)
+		timer._expires = _current + 1;
+	_insert(timer);
+	++_count;
+}
+
+void TimerWheel::cancel(Timer& timer) {
+	if (!timer.isPending( ))
+		return;
+	_unlink(timer);
+	--_count;
+}
+
+/* Turn the wheel up to the given time, moving the timers that came due to the expired list */
+void TimerWheel::advance(uint64_t now) {
+	uint64_t target = now / TICK_MS;
+
+	/* Nothing to fire in between, jump straight there */
+	if (_count == 0 && target > _current)
+		_current = target;
+
+	while (_current < target) {
+		++_current;
+
+		/* Each time a level wraps around, bring the next slot of the level above down */
+		for (size_t level = 1; level < LEVELS; ++level) {
+			if (_current & ((uint64_t(1) << (level * BITS)) - 1))
+				break;
+			_cascade(level);
+		}
+
+		Timer& head = _slots[0][_current & (SLOTS - 1)];
+		while (head._next != &head) {
+			Timer& timer = *head._next;
+			_unlink(timer);
+			_link(_expired, timer);
+		}
+	}
+}
+
+/* Unlink and return the next fired timer, or NULL. Fired timers are popped one at a
+ * time so that handling one may safely cancel another. */
+Timer* TimerWheel::popExpired( ) {
+	if (_expired._next == &_expired)
+		return NULL;
+
+	Timer* timer = _expired._next;
+	_unlink(*timer);
+	--_count;
+	return timer;
+}
+
+/* Milliseconds until the wheel next needs advancing, or -1 if there is nothing to wait for.
+ * Far away timers only give the time of their next cascade, the wait is recomputed then. */
+int TimerWheel::timeout(uint64_t now) const {
+	uint64_t next = ~uint64_t(0);
+
+	if (_expired._next != &_expired)
+		return 0;
+	if (_count == 0)
+		return -1;
+
+	/* Earliest tick at which a non-empty slot of any level is reached */
+	for (size_t level = 0; level < LEVELS; ++level) {
+		uint64_t base = _current >> (level * BITS);
+		for (uint64_t step = 1; step <= SLOTS; ++step) {
+			const Timer& head = _slots[level][(base + step) & (SLOTS - 1)];
+			if (head._next != &head) {
+				next = std::min(next, (base + step) << (level * BITS));
+				break;
+			}
+		}
+	}
+
+	if (next * TICK_MS <= now)
+		return 0;
+	return std::min< uint64_t >(next * TICK_MS - now, INT_MAX);
+}
+
+/***********************************/
+/*         Private Functions       */
+/***********************************/
+
+/* Place a timer in the level matching how far away it is */
+void TimerWheel::_insert(Timer& timer) {
+	uint64_t maxDelta = (uint64_t(1) << (LEVELS * BITS)) - 1;
+	uint64_t delta;
+	size_t   level;
+
+	if (timer._expires - _current > maxDelta)
+		timer._expires = _current + maxDelta;
+	delta = timer._expires - _current;
+
+	for (level = 0; level < LEVELS - 1; ++level)
+		if (delta < (uint64_t(1) << ((level + 1) * BITS)))
+			break;
+	_link(_slots[level][(timer._expires >> (level * BITS)) & (SLOTS - 1)], timer);
+}
+
+/* Redistribute the current slot of a level over the levels below */
+void TimerWheel::_cascade(size_t level) {
+	Timer& head = _slots[level][(_current >> (level * BITS)) & (SLOTS - 1)];
+
+	while (head._next != &head) {
+		Timer& timer = *head._next;
+		_unlink(timer);
+		_insert(timer);
+	}
+}
+
+void TimerWheel::_link(Timer& head, Timer& timer) {
+	timer._prev       = head._prev;
+	timer._next       = &head;
+	head._prev->_next = &timer;
+	head._prev        = &timer;
+}
+
+void TimerWheel::_unlink(Timer& timer) {
+	timer._prev->_next = timer._next;
+	timer._next->_prev = timer._prev;
+	timer._prev        = NULL;
+	timer._next        = NULL;
+}
@@ -0,0 +1,56 @@
+/* Local Includes */
+#include "Trace.hpp"
+#include "defines.h"
+
+/* System Includes */
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <time.h>
+
+std::vector<std::string> Trace::_commandNames(1, "unknown");
+
+Trace::Trace( ) : _events(TRACE_RING_SIZE), _next(0) {}
+
+uint64_t Trace::now( ) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return static_cast< uint64_t >(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+uint8_t Trace::registerCommand(const std::string& name) {
+	_commandNames.push_back(name);
+	return static_cast< uint8_t >(_commandNames.size( ) - 1);
+}
+
+bool Trace::dump(const std::string& path, size_t loop) const {
+	FILE* file = std::fopen(path.c_str( ), "wb");
+	if (!file)
+		return false;
+
+	Header header;
+	std::memcpy(header.magic, "IRCTRACE", sizeof(header.magic));
+	header.version    = VERSION;
+	header.loop       = loop;
+	header.nbCommands = _commandNames.size( );
+	header.nbEvents   = (_next < _events.size( )) ? _next : _events.size( );
+	bool ok           = std::fwrite(&header, sizeof(header), 1, file) == 1;
+
+	for (size_t i = 0; ok && i < _commandNames.size( ); ++i) {
+		char name[NAME_SIZE] = {0};
+		std::strncpy(name, _commandNames[i].c_str( ), NAME_SIZE - 1);
+		ok = std::fwrite(name, NAME_SIZE, 1, file) == 1;
+	}
+
+	/* Once the ring has wrapped around, the oldest event is the next one to be overwritten */
+	size_t first = (_next - header.nbEvents) & (_events.size( ) - 1);
+	size_t tail  = std::min< size_t >(header.nbEvents, _events.size( ) - first);
+	if (ok && tail)
+		ok = std::fwrite(&_events[first], sizeof(Event), tail, file) == tail;
+	if (ok && header.nbEvents > tail)
+		ok = std::fwrite(&_events[0], sizeof(Event), header.nbEvents - tail, file)
+		  == header.nbEvents - tail;
+
+	return (std::fclose(file) == 0) && ok;
+}
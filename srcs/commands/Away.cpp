@@ -26,13 +26,13 @@ void	Away::execute(const Message& msg) {
 				msg._client->setAwayMessage("");
 			}
 			else
-				msg._client->setAwayMessage(msg.getTrailing());
+				msg._client->setAwayMessage(msg.getTrailing().str());
 		}
 		else if (!msg.getTrailing().empty())
 		{
 			msg._client->reply(RPL_NOWAWAY(_server->getHostname(), _client->getNickname()));
 			msg._client->setGlobalModes(AWAY, false);
-			msg._client->setAwayMessage(msg.getTrailing());
+			msg._client->setAwayMessage(msg.getTrailing().str());
 		}
 	}
 }
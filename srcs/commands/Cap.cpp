@@ -0,0 +1,79 @@
+#include "commands/Cap.hpp"
+
+/* Capabilities offered in CAP LS */
+static const struct {
+	const char*	name;
+	int			flag;
+} s_capabilities[] = {
+	{"message-tags", Client::CAP_MESSAGE_TAGS},
+	{"server-time", Client::CAP_SERVER_TIME}
+};
+
+static const size_t s_nbCapabilities = sizeof(s_capabilities) / sizeof(s_capabilities[0]);
+
+Cap::Cap(Server *server) : Command("cap", server) { }
+
+/* IRCv3 capability negotiation. Registration is held back from the first LS or REQ until END. */
+void	Cap::execute(const Message& msg) {
+	Client*		client = msg._client;
+	StringView	subcommand = msg.getMiddle(0);
+	std::string	nick = client->getNickname().empty() ? "*" : client->getNickname();
+	std::string	caps;
+
+	if (subcommand == "LS" || subcommand == "LIST")
+	{
+		if (subcommand == "LS" && !client->getRegistration())
+			client->setNegotiating(true);
+		for (size_t i = 0; i < s_nbCapabilities; ++i)
+		{
+			if (subcommand == "LIST" && !(client->getCapabilities() & s_capabilities[i].flag))
+				continue;
+			caps += (caps.empty() ? "" : " ") + std::string(s_capabilities[i].name);
+		}
+		client->reply(CMD_CAP(_server->getHostname(), nick, subcommand.str(), caps));
+	}
+	else if (subcommand == "REQ")
+	{
+		StringView list = msg.hasTrailing() ? msg.getTrailing() : msg.getMiddle(1);
+
+		if (!client->getRegistration())
+			client->setNegotiating(true);
+		/* The request is applied as a whole or not at all */
+		client->reply(CMD_CAP(_server->getHostname(), nick, _request(client, list) ? "ACK" : "NAK", list.str()));
+	}
+	else if (subcommand == "END")
+	{
+		client->setNegotiating(false);
+		_completeRegistration(msg);
+	}
+	else
+		client->reply(ERR_INVALIDCAPCMD(_server->getHostname(), nick, subcommand.str()));
+}
+
+/* Apply a space separated list of capabilities, '-' disabling one, if all of them are known */
+bool	Cap::_request(Client* client, StringView list) {
+	int		enabled = client->getCapabilities();
+	size_t	pos = 0;
+
+	while (pos < list.size())
+	{
+		size_t end = pos;
+		while (end < list.size() && list[end] != ' ')
+			++end;
+
+		bool		remove = (list[pos] == '-');
+		StringView	name(list.data() + pos + remove, end - pos - remove);
+		size_t		i = 0;
+		while (i < s_nbCapabilities && name != s_capabilities[i].name)
+			++i;
+		if (i == s_nbCapabilities)
+			return false;
+		enabled = remove ? (enabled & ~s_capabilities[i].flag) : (enabled | s_capabilities[i].flag);
+
+		pos = end;
+		while (pos < list.size() && list[pos] == ' ')
+			++pos;
+	}
+	client->setCapabilities(enabled);
+	return true;
+}
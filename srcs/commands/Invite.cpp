@@ -8,15 +8,8 @@ Invite::Invite(Server* server) : Command("invite", server) {
 Invite::~Invite( ) {}
 
 bool Invite::validate(const Message& msg) {
-	/* Ensure that there is both a target user and a target channel parameter */
-	if (msg.getMiddle( ).size( ) < 2) {
-		_client->reply(ERR_NEEDMOREPARAMS(
-		  _server->getHostname( ), _client->getNickname( ), msg.getCommand( )));
-		return false;
-	}
-
-	std::string nickname = msg.getMiddle( ).at(0);
-	std::string channel  = msg.getMiddle( ).at(1);
+	std::string nickname = msg.getMiddle(0).str();
+	std::string channel  = msg.getMiddle(1).str();
 
 	/* Check if target user exists */
 	if (!_server->doesNickExist(nickname)) {
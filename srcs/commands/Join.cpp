@@ -4,24 +4,17 @@ Join::Join(Server* server) : Command("join", server) {}
 
 /* Parse raw message data into vector of channel/password pairs */
 bool Join::parse(const Message& msg) {
-	/* Error message if not enough information received to execute command */
-	if (msg.getMiddle( ).empty( )) {
-		_client->reply(ERR_NEEDMOREPARAMS(
-		  _server->getHostname( ), _client->getNickname( ), msg.getCommand( )));
-		return (false);
-	}
-
 	/* Split all requested channels into _targets vector */
-	std::string rawChannels = msg.getMiddle( ).at(0);
+	std::string rawChannels = msg.getMiddle(0).str();
 	size_t      posChannels = rawChannels.find(',');
 	std::string rawPasswords;
 	size_t      posPasswords = std::string::npos;
 	bool        pass         = false;
 
 	/* Check if passwords were also provided */
-	if (msg.getMiddle( ).size( ) > 1) {
+	if (msg.getMiddleCount( ) > 1) {
 		pass         = true;
-		rawPasswords = msg.getMiddle( ).at(1);
+		rawPasswords = msg.getMiddle(1).str();
 		posPasswords = rawPasswords.find(',');
 	}
 
@@ -143,11 +136,12 @@ void Join::execute(const Message& msg) {
 		if (!hasJoined)
 			channelPtr->setMemberModes(_client, C_OP);
 
-		/* Send reply messages */
-		_client->reply(RPL_NAMREPLY(_server->getHostname( ),
-		                            _client->getNickname( ),
-		                            name,
-		                            channelPtr->getMemberList(channelPtr->isMember(_client))));
+		/* Send reply messages, the member list is shared by everyone joining */
+		const std::vector< std::string >& names
+		  = channelPtr->getNameReplies(_server->getHostname( ), true);
+		for (size_t i = 0; i < names.size( ); ++i)
+			_client->reply(
+			  RPL_NAMREPLY(_server->getHostname( ), _client->getNickname( ), name, names[i]));
 		_client->reply(
 		  RPL_ENDOFNAMES(_server->getHostname( ), _client->getNickname( ), name));
 
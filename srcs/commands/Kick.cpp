@@ -3,16 +3,8 @@
 Kick::Kick(Server* server) : Command("kick", server) { }
 
 bool	Kick::validate(const Message& msg) {
-	std::vector<std::string>	middle = msg.getMiddle();
-
-	/* Check if there's a target for the command */
-	if (middle.size() < 2)
-	{
-		_client->reply(ERR_NEEDMOREPARAMS(_server->getHostname(), _client->getNickname(), msg.getCommand()));
-		return false;
-	}
-	_targetChannel = middle.at(0);
-	_targetUser = middle.at(1);
+	_targetChannel = msg.getMiddle(0).str();
+	_targetUser = msg.getMiddle(1).str();
 
 
 	/* Check if channel exists */
@@ -58,7 +50,7 @@ void	Kick::execute(const Message& msg) {
 	if (validate(msg)) {
 		
 		/* If a kick message was provided then add to reply */
-		_message = msg.getTrailing();
+		_message = msg.getTrailing().str();
 	
 		/* Send message to all channel members */
 		_channel->sendToAll(CMD_KICK(_buildPrefix(msg), _targetChannel, _targetUser, _message));
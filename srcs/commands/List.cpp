@@ -12,9 +12,9 @@ bool List::validate(const Message& msg) {
 	if (msg.hasMiddle( )) {
 		/* If target is valid, attribute it to private member,
 		 * Else, send back an error without a reply */
-		if (msg.hasMiddle( ) > 0 && msg.getMiddle( ).at(0).size( ) > 0) {
-			if (_server->doesChannelExist(msg.getMiddle( ).at(0))) {
-				_target    = msg.getMiddle( ).at(0);
+		if (!msg.getMiddle(0).empty( )) {
+			if (_server->doesChannelExist(msg.getMiddle(0).str())) {
+				_target    = msg.getMiddle(0).str();
 				_hasTarget = true;
 			}
 			else
@@ -38,7 +38,7 @@ void List::execute(const Message& msg) {
 					  RPL_LIST(_server->getHostname( ),
 					           msg._client->getNickname( ),
 					           it->first,
-					           std::to_string(it->second->getMemberVector( ).size( )),
+					           std::to_string(it->second->getNbVisibleUsers( )),
 					           it->second->getTopic( )));
 			}
 		}
@@ -9,15 +9,13 @@ Mode::~Mode( ) {}
 
 /* Parse incoming mode request */
 bool Mode::parse(const Message &msg) {
-	std::vector< std::string > input = msg.getMiddle( );
-
 	/* Check if there is any target for command */
-	if (input.empty( ) || input.at(0).empty( ))
+	if (msg.getMiddle(0).empty( ))
 		return false;
 
-	std::vector< std::string >::const_iterator it = input.begin( );
+	size_t i = 0;
 	/* Get primary target */
-	_target                                       = *it++;
+	_target = msg.getMiddle(i++).str( );
 
 	/* Check if target is channel */
 	if (_target.at(0) == '#')
@@ -26,12 +24,12 @@ bool Mode::parse(const Message &msg) {
 		_targetType = USER;
 
 	/* Check for modes and add to _modes string */
-	if (it != input.end( ))
-		_modes = *it++;
+	if (i < msg.getMiddleCount( ))
+		_modes = msg.getMiddle(i++).str( );
 
 	/* Check for secondary user target(s) for channel member modes */
-	while (it != input.end( ))
-		_params.push_back(*it++);
+	while (i < msg.getMiddleCount( ))
+		_params.push_back(msg.getMiddle(i++).str( ));
 
 	return true;
 }
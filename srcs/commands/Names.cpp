@@ -14,9 +14,9 @@ bool	Names::validate(const Message& msg) {
 	if (msg.hasMiddle())
 	{
 		/*checks if the command has a _target and if said _target is valid sets it, else sends back an error without a reply */
-		if (msg.hasMiddle() > 0 && msg.getMiddle().at(0).size() > 0) {
-			if (_server->doesChannelExist(msg.getMiddle().at(0))) {
-				_target = msg.getMiddle().at(0);
+		if (!msg.getMiddle(0).empty()) {
+			if (_server->doesChannelExist(msg.getMiddle(0).str())) {
+				_target = msg.getMiddle(0).str();
 				_hasTarget = true;
 			}
 			else
@@ -37,10 +37,8 @@ void	Names::execute(const Message& msg) {
 			bool clientIsMember = targetChannel->isMember(msg._client);
 
 			/*if the command has a _target, sends back its name and users as reply*/
-			if (!targetChannel->checkModes(SECRET) || clientIsMember) {
-				msg._client->reply(RPL_NAMREPLY(_server->getHostname(), msg._client->getNickname(), _target,
-												targetChannel->getMemberList(clientIsMember)));
-			}
+			if (!targetChannel->checkModes(SECRET) || clientIsMember)
+				_replyNames(msg._client, targetChannel, clientIsMember);
 			msg._client->reply(RPL_ENDOFNAMES(_server->getHostname(), msg._client->getNickname(), _target));
 		}
 		else
@@ -51,12 +49,20 @@ void	Names::execute(const Message& msg) {
 			ChannelList::iterator iteC = channelList.end();
 			for (; itC != iteC; ++itC)
 			{
-				if (!itC->second->checkModes(SECRET) || itC->second->isMember(msg._client)) {
-					msg._client->reply(RPL_NAMREPLY(_server->getHostname(), msg._client->getNickname(), itC->first,
-													itC->second->getMemberList(itC->second->isMember(msg._client))));
+				bool clientIsMember = itC->second->isMember(msg._client);
+				if (!itC->second->checkModes(SECRET) || clientIsMember) {
+					_replyNames(msg._client, itC->second, clientIsMember);
 					msg._client->reply(RPL_ENDOFNAMES(_server->getHostname(), msg._client->getNickname(), itC->first));
 				}
 			}
 		}
 	}
-}
\ No newline at end of file
+}
+
+/* Send the channel's cached member list, split over as many replies as needed */
+void	Names::_replyNames(Client* client, Channel* channel, bool isMember) {
+	const std::vector<std::string>& names = channel->getNameReplies(_server->getHostname(), isMember);
+
+	for (size_t i = 0; i < names.size(); ++i)
+		client->reply(RPL_NAMREPLY(_server->getHostname(), client->getNickname(), channel->getName(), names[i]));
+}
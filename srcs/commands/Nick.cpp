@@ -4,18 +4,16 @@
 Nick::Nick(Server* server) : Command("nick", server) { }
 
 bool Nick::validate(const Message& msg) {
-	std::vector<std::string>	middle = msg.getMiddle();
-
 	/* Check if a nickname was given */
-	if (middle.empty())
+	if (!msg.hasMiddle())
 	{
 		_client->reply(ERR_NONICKNAMEGIVEN(_server->getHostname()));
 		return (false);
 	}
-	_nick = middle.at(0);
+	_nick = msg.getMiddle(0).str();
 
 	/* If nickname is too long, return error */
-	if (_nick.size() > 9)
+	if (_nick.size() > NICK_MAX_LENGTH)
 	{
 		_client->reply(ERR_ERRONEUSNICKNAME(_server->getHostname(), _nick));
 		return false;
@@ -25,8 +23,9 @@ bool Nick::validate(const Message& msg) {
 	if (_client->getNickname() == _nick)
 		return (false);
 
-	/* If nickname is already in use, return error */
-	if (_server->doesNickExist(_nick))
+	/* If nickname is already in use by someone else, return error. Changing its case is fine. */
+	Client* owner = _server->getClientPtr(_nick);
+	if (owner && owner != _client)
 	{
 		_client->reply(ERR_NICKNAMEINUSE(_server->getHostname(), _nick));
 		return (false);
@@ -43,13 +42,8 @@ void Nick::execute(const Message &msg) {
 		/* If client already registered, send notification of nickname change */
 		if (_client->getRegistration())
 			_client->reply(CMD_NICK(_buildPrefix(msg), _nick));
-		_client->setNickname(_nick);
+		_server->changeNickname(_client, _nick);
 	}
 	 /* If username and nickname have been successfully added, register user*/
-    if (!_client->getUsername().empty() && !_client->getNickname().empty() && !_client->getRegistration())
-    {
-        _client->setRegistration(true);
-        _client->reply(RPL_WELCOME(_server->getHostname(), _client->getNickname(), _buildPrefix(msg)));
-        std::cout << getTimestamp() << GREEN "New user successfully registered: " CLEAR << _client->getNickname() << std::endl;
-    }
+	_completeRegistration(msg);
 }
\ No newline at end of file
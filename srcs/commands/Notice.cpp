@@ -10,7 +10,7 @@ bool	Notice::validate(const Message& msg) {
 	if (!msg.hasMiddle())
 		return false;
 
-	_target = msg.getMiddle().at(0);
+	_target = msg.getMiddle(0).str();
 
 	/* If target is a channel */
     if(_target.at(0) == '#')
@@ -48,7 +48,7 @@ void	Notice::execute(const Message& msg) {
 
 	if (!validate(msg))
 		return ;
-	_message = msg.getTrailing();
+	_message = msg.getTrailing().str();
 
 	if (_targetIsChannel)
 		_channel->sendToOthers(CMD_NOTICE(_buildPrefix(msg), _target, _message), _client);
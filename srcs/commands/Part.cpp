@@ -5,14 +5,7 @@ Part::Part(Server* server) : Command("part", server) { }
 /* Parse msg to get list of all channels */
 bool	Part::parse(const Message& msg)
 {
-	/* If message is empty send error reply */
-    if (msg.getMiddle().empty())
-	{
-		msg._client->reply(ERR_NEEDMOREPARAMS(_server->getHostname(), _client->getNickname(), msg.getCommand()));
-		return false;
-	}
-
-	std::string raw = msg.getMiddle().at(0);
+	std::string raw = msg.getMiddle(0).str();
 	size_t pos;
 
 	/* Iterate through string and split out all channel names */
@@ -25,7 +18,7 @@ bool	Part::parse(const Message& msg)
 		_targetChannels.push_back(raw);
 	
 	/* Get part message */
-    _message = msg.getTrailing();
+    _message = msg.getTrailing().str();
 	
 	return true;
 }
@@ -3,12 +3,7 @@
 Pass::Pass(Server* server) : Command("pass", server), _password(server->getServerPassword()) { }
 
 bool	Pass::validate(const Message& msg) {
-	/* If no password is supplied, send error */
-	if (msg.getMiddle().empty())
-	{
-		_client->reply(ERR_NEEDMOREPARAMS(_server->getHostname(), _client->getNickname(), msg.getCommand()));
-		return false;
-	}
+	(void)msg;
 	/* If client has already registered send error */
 	if (_client->getRegistration())
 	{
@@ -23,7 +18,7 @@ void	Pass::execute(const Message& msg) {
 	if (validate(msg))
 	{
 		/* If password matches set status true */
-		if (msg.getMiddle().at(0) == _password)
+		if (msg.getMiddle(0) == _password)
 			_client->setPassStatus(true);
 		else
 			throw passException();
@@ -6,7 +6,7 @@ void	Ping::execute(const Message& msg) {
 	std::string token;
 	
 	/* If anything other than just PING received sent back same token, otherwise send empty string */
-	if (!msg.getMiddle().empty())
-		token = msg.getMiddle().at(0);
+	if (msg.hasMiddle())
+		token = msg.getMiddle(0).str();
 	msg._client->reply(CMD_PONG(_server->getHostname(), token));
 }
\ No newline at end of file
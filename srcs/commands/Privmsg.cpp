@@ -8,16 +8,13 @@ Privmsg::~Privmsg( ) {}
 /* Public Member Functions */
 
 bool Privmsg::validate(const Message& msg) {
-	std::vector< std::string > args = msg.getMiddle( );
-
 	/* Ensure there's a target for the message */
-	if (args.size( ) < 1) {
+	if (!msg.hasMiddle( )) {
 		msg._client->reply(ERR_NORECIPIENT(
-		  _server->getHostname( ), _client->getNickname( ), msg.getCommand( )));
+		  _server->getHostname( ), _client->getNickname( ), _name));
 		return false;
 	}
-	_target = args.at(0);
-	args.erase(args.begin( ));
+	_target = msg.getMiddle(0).str( );
 	if (_message.empty( )) {
 		msg._client->reply(
 		  ERR_NOTEXTTOSEND(_server->getHostname( ), _client->getNickname( ), _target));
@@ -98,11 +95,11 @@ void Privmsg::_buildMessage(const Message& msg) {
 	/* Clear the message buffer, since the Privmsg object never gets out of scope */
 	_message.clear( );
 
-	size_t nb_args = msg.getMiddle( ).size( );
+	size_t nb_args = msg.getMiddleCount( );
 
 	/* If the message was a single word, some clients (e.g. Limechat) do not
 	    prepend a ':' before it, so it stays in the msg's _middle field */
 	for (size_t i = 2; i < nb_args; ++i)
-		_message.append(msg.getMiddle( ).at(i));
-	_message.append(msg.getTrailing( ));
+		_message.append(msg.getMiddle(i).data( ), msg.getMiddle(i).size( ));
+	_message.append(msg.getTrailing( ).data( ), msg.getTrailing( ).size( ));
 }
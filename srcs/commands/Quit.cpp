@@ -4,7 +4,7 @@ Quit::Quit(Server* server) : Command("quit", server) { }
 
 bool	Quit::validate(const Message& msg) {
 
-	std::string tmp = msg.getCommand();
+	(void)msg;
 	return (true);
 }
 
@@ -13,18 +13,15 @@ void	Quit::execute(const Message& msg) {
 	std::string message = "";
 	if (!msg.getTrailing().empty())
 	{
-		message += msg.getTrailing();
+		message += msg.getTrailing().str();
 	}
 	Client *_client = msg._client;
-	/* Iterate over every channel to see which the target user is part of*/
-	ChannelList channelList = _server->getChannelList();
-	ChannelList::iterator it = channelList.begin();
-	ChannelList::iterator ite = channelList.end();
-	for (; it != ite; ++it)
+	/* Iterate over the channels the user is part of */
+	const std::vector<Channel*>& channels = _client->getChannels();
+	for (size_t i = 0; i < channels.size(); ++i)
 	{
 		/*Sends a quit message to every user on the channel then remove client member*/
-		if (it->second->isMember(_client))
-			it->second->sendToAll(CMD_PART(_buildPrefix(msg), it->first, message));
+		channels[i]->sendToAll(CMD_PART(_buildPrefix(msg), channels[i]->getName(), message));
 	}
 	_server->removeClient(msg._client);
 }
\ No newline at end of file
@@ -5,13 +5,7 @@ Topic::Topic(Server* server) : Command("topic", server) { }
 /* Attempt to validate if command can be executed */
 bool	Topic::validate(const Message& msg) {
 
-	/* Check if any parameters were passed */
-	if (!msg.hasMiddle())
-	{
-		_client->reply(ERR_NEEDMOREPARAMS(_server->getHostname(), _client->getNickname(), msg.getCommand()));
-		return false;
-	}
-	_target = msg.getMiddle().at(0);
+	_target = msg.getMiddle(0).str();
 	
 	/* Check if target channel exists */
 	if (!_server->doesChannelExist(_target))
@@ -61,8 +55,8 @@ void	Topic::execute(const Message& msg) {
 		/* If message has trailing and trailing is not empty, set the topic */
 		else if (msg.hasTrailing() && !msg.getTrailing().empty())
 		{
-			_channel->setTopic(msg.getTrailing());
-			_channel->sendToAll(":" + _buildPrefix(msg) + " TOPIC " + _target + " :"+ msg.getTrailing() + "\r\n");
+			_channel->setTopic(msg.getTrailing().str());
+			_channel->sendToAll(":" + _buildPrefix(msg) + " TOPIC " + _target + " :"+ msg.getTrailing().str() + "\r\n");
 		}
 		/* If message does not have trailing, send the current topic */
 		else
@@ -0,0 +1,26 @@
+/* Local Includes */
+#include "commands/TraceDump.hpp"
+
+TraceDump::TraceDump(Server* server) : Command("tracedump", server) {
+
+}
+
+TraceDump::~TraceDump() {
+
+}
+
+/* Have every event loop dump its flight recorder, same as sending SIGUSR1. Dumps write to the
+ * server's disk, so only clients on this host, or giving IRC_ADMIN_PASSWORD, may ask for one. */
+void	TraceDump::execute(const Message& msg) {
+	const std::string&	password = _server->getConfig().adminPassword;
+	bool				allowed = msg._client->isLoopback();
+
+	if (!allowed && !password.empty() && msg.getMiddleCount() > 0)
+		allowed = msg.getMiddle(0).str() == password;
+	if (!allowed)
+		msg._client->reply(ERR_NOPRIVILEGES(_server->getHostname(), msg._client->getNickname()));
+	else if (_server->dumpTraces())
+		msg._client->reply(CMD_NOTICE(_server->getHostname(), msg._client->getNickname(), "Dumping event loop traces"));
+	else
+		msg._client->reply(CMD_NOTICE(_server->getHostname(), msg._client->getNickname(), "Trace dump ignored, try again later"));
+}
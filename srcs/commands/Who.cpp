@@ -1,4 +1,5 @@
 #include "commands/Who.hpp"
+#include "Logger.hpp"
 
 Who::Who(Server* server) : Command("who", server) {
 	_channelOpRequired = false;
@@ -11,11 +12,11 @@ Who::~Who( ) {}
 bool Who::validate(const Message& msg) {
 	_target = nullptr;
 	/* If no target, will list all users with no common channels */
-	if (!msg.hasMiddle( ) || msg.getMiddle( ).at(0).empty( )) {
+	if (!msg.hasMiddle( ) || msg.getMiddle(0).empty( )) {
 		return false;
 	}
 
-	std::string target = msg.getMiddle( ).at(0);
+	std::string target = msg.getMiddle(0).str();
 	/* If target is channel, will list all users on that channel */
 	if (!target.empty( ) && target.at(0) == '#') {
 		_targetType = CHANNEL;
@@ -69,8 +70,7 @@ void Who::_listChannelMembers( ) {
 		}
 		Client* currMemberPtr = _server->getClientPtr(currMember);
 		if (!currMemberPtr) {
-			std::cerr << "Error retrieving client ptr for '" << currMember << "'."
-			          << std::endl;
+			LOG(COMMANDS, ERROR, "Error retrieving client ptr for '" << currMember << "'.");
 			continue;
 		}
 		// For each channel member, send a RPL_WHOREPLY with their status on the channel
@@ -104,27 +104,24 @@ void Who::_listClientChannels( ) {
 		                           targetMember->getNickname( )));
 		return;
 	}
-	ChannelList           channels = _server->getChannelList( );
-	ChannelList::iterator ite      = channels.end( );
+	const std::vector< Channel* >& channels = targetMember->getChannels( );
 	std::string	currMember = targetMember->getNickname();
 	if (targetMember->checkGlobalModes(AWAY))
 		currMember.append(" G");
 	else
 		currMember.append(" H");
 	// For each channel of which client is a member, send a RPL_WHOREPLY with their status on channel
-	for (ChannelList::iterator it = channels.begin( ); it != ite; ++it) {
+	for (size_t i = 0; i < channels.size( ); ++i) {
 		if (*(currMember.end() - 1) == '@')
 			currMember.erase(currMember.end() - 1, currMember.end());
-		if (it->second->isMember(targetMember)) {
-			if (it->second->checkMemberModes(targetMember, C_OP | OWNER))
-				currMember.append("@");
-			_client->reply(RPL_WHOREPLY(_server->getHostname( ),
-			                            targetMember->getNickname( ),
-			                            it->first,
-			                            _client->getUsername( ),
-			                            currMember,
-			                            targetMember->getRealname( )));
-		}
+		if (channels[i]->checkMemberModes(targetMember, C_OP | OWNER))
+			currMember.append("@");
+		_client->reply(RPL_WHOREPLY(_server->getHostname( ),
+		                            targetMember->getNickname( ),
+		                            channels[i]->getName( ),
+		                            _client->getUsername( ),
+		                            currMember,
+		                            targetMember->getRealname( )));
 	}
 	_client->reply(RPL_ENDOFWHO(
 	  _server->getHostname( ), _client->getNickname( ), targetMember->getNickname( )));
@@ -1,4 +1,5 @@
 #include "../../includes/commands/Whois.hpp"
+#include "Clock.hpp"
 
 Whois::Whois(Server* server) : Command("whois", server) {
 	_channelOpRequired = false;
@@ -12,7 +13,7 @@ bool Whois::validate(const Message& msg) {
 		msg._client->reply(ERR_NONICKNAMEGIVEN(_server->getHostname( )));
 		return false;
 	}
-	std::string target = msg.getMiddle( ).at(0);
+	std::string target = msg.getMiddle(0).str();
 
 	if (!_server->doesNickExist(target)) {
 		msg._client->reply(
@@ -35,25 +36,22 @@ void Whois::execute(const Message& msg) {
 		msg._client->reply(
 		  RPL_WHOISUSER(host, _client->getNickname( ), nick, user, address, real));
 
-		/* Iterate over every channel to see which the target user is part of */
-		ChannelList           channelList = _server->getChannelList( );
-		ChannelList::iterator it          = channelList.begin( );
-		ChannelList::iterator ite         = channelList.end( );
-		bool                  hasTargets  = false;
+		/* Iterate over the channels the target user is part of */
+		const std::vector< Channel* >& channels   = _target->getChannels( );
+		bool                           hasTargets = false;
 
-		
 		std::string reply;
-		for (; it != ite; ++it) {
+		for (size_t i = 0; i < channels.size( ); ++i) {
 			/* If both querying and target users share the channel, target is not set as
 			 * invisible, and channel is not set as secret, send RPL_WHOISCHANNELS */
-			if (it->second->isMember(_target) && it->second->isMember(msg._client)
-			    && !_target->checkGlobalModes(INVIS) && !it->second->checkModes(SECRET)) {
+			if (channels[i]->isMember(msg._client) && !_target->checkGlobalModes(INVIS)
+			    && !channels[i]->checkModes(SECRET)) {
 				if (hasTargets)
 					reply += ",";
-				if (it->second->checkMemberModes(_target, C_OP))
-					reply += "@" + it->first;
+				if (channels[i]->checkMemberModes(_target, C_OP))
+					reply += "@" + channels[i]->getName( );
 				else
-					reply += it->first;
+					reply += channels[i]->getName( );
 				hasTargets = true;
 			}
 		}
@@ -70,7 +68,7 @@ void Whois::execute(const Message& msg) {
 		  _server->getHostname( ),
 		  _client->getNickname( ),
 		  _target->getNickname( ),
-		  std::to_string(std::time(nullptr) - _target->getLastActivityTime( )),
+		  std::to_string(Clock::wall( ) - _target->getLastActivityTime( )),
 		  std::to_string(_target->getConnectTime( ))));
 		msg._client->reply(RPL_AWAY(_target->getHostname( ),
 		                            msg._client->getNickname( ),
@@ -1,7 +1,12 @@
 /* Local Includes */
+#include "Logger.hpp"
 #include "Server.hpp"
 
+/* System Includes */
+#include <csignal>
+
 int g_status = OFFLINE;
+int g_traceDump = 0;
 
 void	sig_terminate(int signum) {
 	(void) signum;
@@ -9,6 +14,11 @@ void	sig_terminate(int signum) {
 	g_status = OFFLINE;
 }
 
+void	sig_traceDump(int signum) {
+	(void) signum;
+	g_traceDump = 1;
+}
+
 int	main(int argc, char **argv)	{
 	/* Send usage error message if parameters are not correct */
 	if (argc != 3)
@@ -18,15 +28,21 @@ int	main(int argc, char **argv)	{
 	else
 	{
 		signal(SIGINT, sig_terminate);
+		signal(SIGUSR1, sig_traceDump);
 		std::string servername = argv[0];
 		servername.erase(0, 2);
+		Config config;
+		config.loadEnvironment();
+		Logger::start(config);
 		try {
-			Server server(servername, atoi(argv[1]), argv[2]);
+			Server server(servername, atoi(argv[1]), argv[2], config);
 		} catch (std::runtime_error &e) {
+			Logger::stop();
 			std::cerr << "Caught runtime error of type " << e.what() 
 				      << ". Exiting program" << std::endl;
 			return 1;
 		}
+		Logger::stop();
 	}
 	return 0;
 }
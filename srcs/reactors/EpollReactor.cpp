@@ -0,0 +1,87 @@
+#include "reactors/EpollReactor.hpp"
+
+#ifdef __linux__
+
+#include <stdexcept>
+#include <unistd.h>
+
+/* Translate reactor event flags into epoll flags */
+static uint32_t toEpollEvents(int events) {
+	uint32_t epollEvents = 0;
+
+	if (events & Reactor::READABLE)
+		epollEvents |= EPOLLIN | EPOLLRDHUP;
+	if (events & Reactor::WRITABLE)
+		epollEvents |= EPOLLOUT;
+	return epollEvents;
+}
+
+EpollReactor::EpollReactor() : _nbRegistered(0) {
+	if ((_epfd = epoll_create1(EPOLL_CLOEXEC)) < 0)
+		throw std::runtime_error("Unable to create epoll instance");
+}
+
+EpollReactor::~EpollReactor() { close(_epfd); }
+
+/* Register a new socket with the kernel interest list */
+void EpollReactor::add(int fd, int events, void* data) {
+	epoll_event ev;
+
+	ev.events  = toEpollEvents(events);
+	ev.data.fd = fd;
+	if (epoll_ctl(_epfd, EPOLL_CTL_ADD, fd, &ev) < 0)
+		throw std::runtime_error("Unable to add socket to epoll interest list");
+	if ((size_t)fd >= _data.size( ))
+		_data.resize(fd + 1, NULL);
+	_data[fd] = data;
+	++_nbRegistered;
+}
+
+/* Change the events watched for a registered socket */
+void EpollReactor::modify(int fd, int events, void* data) {
+	epoll_event ev;
+
+	ev.events  = toEpollEvents(events);
+	ev.data.fd = fd;
+	if (epoll_ctl(_epfd, EPOLL_CTL_MOD, fd, &ev) < 0)
+		throw std::runtime_error("Unable to modify socket in epoll interest list");
+	_data[fd] = data;
+}
+
+/* Remove a socket from the kernel interest list */
+void EpollReactor::remove(int fd) {
+	if (epoll_ctl(_epfd, EPOLL_CTL_DEL, fd, NULL) < 0)
+		return;
+	_data[fd] = NULL;
+	--_nbRegistered;
+}
+
+/* Wait for events; only ready sockets are returned by the kernel */
+int EpollReactor::wait(std::vector< Event >& ready, int timeout) {
+	ready.clear( );
+	/* Size the output buffer to the interest list so that one call drains every event */
+	size_t capacity = _nbRegistered > 0 ? _nbRegistered : 1;
+	if (_events.size( ) < capacity)
+		_events.resize(capacity);
+
+	int nbReady = epoll_wait(_epfd, _events.data( ), _events.size( ), timeout);
+	if (nbReady <= 0)
+		return nbReady;
+
+	for (int i = 0; i < nbReady; ++i) {
+		int   fd    = _events[i].data.fd;
+		Event event = {.fd = fd, .data = _data[fd], .events = 0, .result = 0, .buffer = NULL};
+
+		if (_events[i].events & EPOLLIN)
+			event.events |= READABLE;
+		if (_events[i].events & EPOLLOUT)
+			event.events |= WRITABLE;
+		/* Hangups and errors are reported as readable so that the next read() sees them */
+		if (_events[i].events & (EPOLLHUP | EPOLLERR | EPOLLRDHUP))
+			event.events |= READABLE | HANGUP;
+		ready.push_back(event);
+	}
+	return nbReady;
+}
+
+#endif
@@ -0,0 +1,83 @@
+#include "reactors/PollReactor.hpp"
+
+#include <stdexcept>
+
+/* Translate reactor event flags into poll() flags */
+static short toPollEvents(int events) {
+	short pollEvents = 0;
+
+	if (events & Reactor::READABLE)
+		pollEvents |= POLLIN;
+	if (events & Reactor::WRITABLE)
+		pollEvents |= POLLOUT;
+	return pollEvents;
+}
+
+/* Register a new socket */
+void PollReactor::add(int fd, int events, void* data) {
+	pollfd pfd = {.fd = fd, .events = toPollEvents(events), .revents = 0};
+
+	if (_find(fd) >= 0)
+		throw std::runtime_error("Unable to add already registered socket");
+	if ((size_t)fd >= _index.size( ))
+		_index.resize(fd + 1, -1);
+	_index[fd] = _pfds.size( );
+	_pfds.push_back(pfd);
+	_data.push_back(data);
+}
+
+/* Change the events watched for a registered socket */
+void PollReactor::modify(int fd, int events, void* data) {
+	int i = _find(fd);
+
+	if (i < 0)
+		throw std::runtime_error("Unable to modify unregistered socket");
+	_pfds[i].events = toPollEvents(events);
+	_data[i]        = data;
+}
+
+/* Stop watching a socket */
+void PollReactor::remove(int fd) {
+	int i = _find(fd);
+
+	if (i < 0)
+		return;
+	_pfds[i]            = _pfds.back( );
+	_data[i]            = _data.back( );
+	_index[_pfds[i].fd] = i;
+	_index[fd]          = -1;
+	_pfds.pop_back( );
+	_data.pop_back( );
+}
+
+/* Poll every registered socket and collect the ones that are ready */
+int PollReactor::wait(std::vector< Event >& ready, int timeout) {
+	ready.clear( );
+	int nbReady = poll(_pfds.data( ), _pfds.size( ), timeout);
+	if (nbReady <= 0)
+		return nbReady;
+
+	for (size_t i = 0; i < _pfds.size( ) && ready.size( ) < (size_t)nbReady; ++i) {
+		short revents = _pfds[i].revents;
+		if (!revents)
+			continue;
+
+		Event event = {.fd = _pfds[i].fd, .data = _data[i], .events = 0, .result = 0, .buffer = NULL};
+		if (revents & POLLIN)
+			event.events |= READABLE;
+		if (revents & POLLOUT)
+			event.events |= WRITABLE;
+		/* Hangups and errors are reported as readable so that the next read() sees them */
+		if (revents & (POLLHUP | POLLERR | POLLNVAL))
+			event.events |= READABLE | HANGUP;
+		ready.push_back(event);
+	}
+	return ready.size( );
+}
+
+/* Return the index of fd in _pfds, or -1 if it is not registered */
+int PollReactor::_find(int fd) const {
+	if (fd < 0 || (size_t)fd >= _index.size( ))
+		return -1;
+	return _index[fd];
+}
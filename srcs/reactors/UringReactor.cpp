@@ -0,0 +1,435 @@
+#include "reactors/UringReactor.hpp"
+
+#ifdef HAS_IO_URING
+
+#include <csignal>
+#include <cstring>
+#include <endian.h>
+#include <errno.h>
+#include <poll.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+/* After the system headers, for the MSG_NOSIGNAL fallback */
+#include "defines.h"
+
+#define URING_ENTRIES 256					/* Submission queue size */
+#define URING_CQ_ENTRIES 4096				/* Completion queue size, accepts and receives outnumber submissions */
+#define URING_BUFFERS 512					/* Provided receive buffers, power of two */
+#define URING_BUFFER_GROUP 0
+#define URING_CANCEL_TAG ((uint64_t)-1)		/* user_data of cancellation requests */
+
+/* Requests a completion can belong to */
+enum e_requests { POLL_REQUEST, ACCEPT_REQUEST, RECV_REQUEST };
+
+/* Translate reactor event flags into a poll mask as expected by io_uring */
+static uint32_t toPollMask(int events) {
+	uint32_t mask = 0;
+
+	if (events & Reactor::READABLE)
+		mask |= POLLIN | POLLRDHUP;
+	if (events & Reactor::WRITABLE)
+		mask |= POLLOUT;
+#if __BYTE_ORDER == __BIG_ENDIAN
+	mask = (mask << 16) | (mask >> 16);
+#endif
+	return mask;
+}
+
+/* user_data carries the fd, the request and the registration generation it was made for */
+static uint64_t toUserData(int fd, int request, uint32_t generation) {
+	return ((uint64_t)(generation & 0x3fffffff) << 34) | ((uint64_t)request << 32) | (uint32_t)fd;
+}
+
+UringReactor::UringReactor( )
+  : _sqRing(MAP_FAILED), _sqes((io_uring_sqe*)MAP_FAILED), _sqPending(0),
+    _cqRing(MAP_FAILED), _bufRing(NULL), _buffers(NULL), _bufTail(0), _multishotAccept(true) {
+	io_uring_params params;
+
+	std::memset(&params, 0, sizeof(params));
+	params.flags      = IORING_SETUP_CQSIZE;
+	params.cq_entries = URING_CQ_ENTRIES;
+	if ((_ringfd = syscall(__NR_io_uring_setup, URING_ENTRIES, &params)) < 0)
+		throw std::runtime_error("io_uring is not supported by this kernel");
+
+	/* Waiting with a timeout relies on IORING_ENTER_EXT_ARG (Linux 5.11) */
+	if (!(params.features & IORING_FEAT_EXT_ARG)) {
+		close(_ringfd);
+		throw std::runtime_error("io_uring is too old, IORING_FEAT_EXT_ARG is missing");
+	}
+
+	/* Map the submission and completion rings, which may share a single mapping */
+	_sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+	_cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+	if (params.features & IORING_FEAT_SINGLE_MMAP) {
+		if (_cqRingSize > _sqRingSize)
+			_sqRingSize = _cqRingSize;
+		_cqRingSize = _sqRingSize;
+	}
+	_sqRing = mmap(NULL,
+	               _sqRingSize,
+	               PROT_READ | PROT_WRITE,
+	               MAP_SHARED | MAP_POPULATE,
+	               _ringfd,
+	               IORING_OFF_SQ_RING);
+	if (params.features & IORING_FEAT_SINGLE_MMAP)
+		_cqRing = _sqRing;
+	else
+		_cqRing = mmap(NULL,
+		               _cqRingSize,
+		               PROT_READ | PROT_WRITE,
+		               MAP_SHARED | MAP_POPULATE,
+		               _ringfd,
+		               IORING_OFF_CQ_RING);
+	_sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+	_sqes     = (io_uring_sqe*)mmap(NULL,
+                                _sqesSize,
+                                PROT_READ | PROT_WRITE,
+                                MAP_SHARED | MAP_POPULATE,
+                                _ringfd,
+                                IORING_OFF_SQES);
+	if (_sqRing == MAP_FAILED || _cqRing == MAP_FAILED || _sqes == MAP_FAILED) {
+		_release( );
+		throw std::runtime_error("Unable to map io_uring rings");
+	}
+
+	char* sq   = static_cast< char* >(_sqRing);
+	char* cq   = static_cast< char* >(_cqRing);
+	_sqHead    = (unsigned*)(sq + params.sq_off.head);
+	_sqTail    = (unsigned*)(sq + params.sq_off.tail);
+	_sqMask    = *(unsigned*)(sq + params.sq_off.ring_mask);
+	_sqEntries = *(unsigned*)(sq + params.sq_off.ring_entries);
+	_sqArray   = (unsigned*)(sq + params.sq_off.array);
+	_cqHead    = (unsigned*)(cq + params.cq_off.head);
+	_cqTail    = (unsigned*)(cq + params.cq_off.tail);
+	_cqMask    = *(unsigned*)(cq + params.cq_off.ring_mask);
+	_cqes      = (io_uring_cqe*)(cq + params.cq_off.cqes);
+
+	_setupBuffers( );
+}
+
+UringReactor::~UringReactor( ) { _release( ); }
+
+/* Close the io_uring instance, which cancels what is in flight, then unmap the rings */
+void UringReactor::_release( ) {
+	close(_ringfd);
+	if (_sqes != MAP_FAILED)
+		munmap(_sqes, _sqesSize);
+	if (_cqRing != MAP_FAILED && _cqRing != _sqRing)
+		munmap(_cqRing, _cqRingSize);
+	if (_sqRing != MAP_FAILED)
+		munmap(_sqRing, _sqRingSize);
+	if (_bufRing)
+		munmap(_bufRing, _bufRingSize);
+	delete[] _buffers;
+}
+
+/* Register the ring of provided receive buffers (Linux 5.19), without it sockets registered
+ * with RECEIVE are polled like the others */
+void UringReactor::_setupBuffers( ) {
+	io_uring_buf_reg reg;
+
+	_bufRingSize = URING_BUFFERS * sizeof(io_uring_buf);
+	void* ring   = mmap(NULL, _bufRingSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (ring == MAP_FAILED)
+		return;
+
+	std::memset(&reg, 0, sizeof(reg));
+	reg.ring_addr    = (uint64_t)(uintptr_t)ring;
+	reg.ring_entries = URING_BUFFERS;
+	reg.bgid         = URING_BUFFER_GROUP;
+	if (syscall(__NR_io_uring_register, _ringfd, IORING_REGISTER_PBUF_RING, &reg, 1) < 0) {
+		munmap(ring, _bufRingSize);
+		return;
+	}
+	_bufRing = static_cast< io_uring_buf* >(ring);
+	_buffers = new char[URING_BUFFERS * RECV_BUFFER_SIZE];
+	for (size_t bid = 0; bid < URING_BUFFERS; ++bid)
+		_lent.push_back(bid);
+	_recycleBuffers( );
+}
+
+/* Hand buffers back to the kernel, once their data has been taken */
+void UringReactor::_recycleBuffers( ) {
+	if (_lent.empty( ))
+		return;
+	for (size_t i = 0; i < _lent.size( ); ++i) {
+		io_uring_buf* buf = &_bufRing[_bufTail++ & (URING_BUFFERS - 1)];
+		buf->addr         = (uint64_t)(uintptr_t)(_buffers + _lent[i] * RECV_BUFFER_SIZE);
+		buf->len          = RECV_BUFFER_SIZE;
+		buf->bid          = _lent[i];
+	}
+	/* The ring tail overlays the reserved field of the first entry */
+	__atomic_store_n(&_bufRing[0].resv, _bufTail, __ATOMIC_RELEASE);
+	_lent.clear( );
+}
+
+/* Request completing the I/O of a registration, POLL_REQUEST when it is only polled */
+int UringReactor::_completionFor(int events) const {
+	if ((events & ACCEPT) && _multishotAccept)
+		return ACCEPT_REQUEST;
+	if ((events & RECEIVE) && _bufRing)
+		return RECV_REQUEST;
+	return POLL_REQUEST;
+}
+
+/* Readiness left to poll for, reading is not when a completion does it. 0 if none. */
+uint32_t UringReactor::_pollMask(int events) const {
+	if (_completionFor(events) != POLL_REQUEST)
+		events &= ~READABLE;
+	return toPollMask(events);
+}
+
+/* Register a new socket, its requests are queued for the next wait() */
+void UringReactor::add(int fd, int events, void* data) {
+	if ((size_t)fd >= _registrations.size( )) {
+		Registration empty = {NULL, 0, 0, 0, false, false, false};
+		_registrations.resize(fd + 1, empty);
+	}
+
+	Registration& reg = _registrations[fd];
+	if (reg.registered)
+		throw std::runtime_error("Unable to add socket already registered with io_uring");
+	reg.data       = data;
+	reg.events     = events;
+	reg.registered = true;
+	reg.armed      = false;
+	reg.pending    = false;
+	++reg.generation;
+	++reg.pollGeneration;
+	_toArm.push_back(fd);
+}
+
+/* Change the events watched for a registered socket */
+void UringReactor::modify(int fd, int events, void* data) {
+	if ((size_t)fd >= _registrations.size( ) || !_registrations[fd].registered)
+		throw std::runtime_error("Unable to modify socket not registered with io_uring");
+
+	Registration& reg = _registrations[fd];
+	reg.data          = data;
+	if (reg.events == events)
+		return;
+	uint32_t mask       = _pollMask(reg.events);
+	int      completion = _completionFor(reg.events);
+	reg.events          = events;
+
+	/* Requests in flight made for the old events are cancelled and made again */
+	if (reg.armed && _pollMask(events) != mask) {
+		_queueCancel(toUserData(fd, POLL_REQUEST, reg.pollGeneration));
+		reg.armed = false;
+		++reg.pollGeneration;
+	}
+	if (reg.pending && _completionFor(events) != completion) {
+		_queueCancel(toUserData(fd, completion, reg.generation));
+		reg.pending = false;
+		++reg.generation;
+	}
+	_toArm.push_back(fd);
+}
+
+/* Stop watching a socket */
+void UringReactor::remove(int fd) {
+	if ((size_t)fd >= _registrations.size( ) || !_registrations[fd].registered)
+		return;
+
+	Registration& reg = _registrations[fd];
+	if (reg.armed)
+		_queueCancel(toUserData(fd, POLL_REQUEST, reg.pollGeneration));
+	if (reg.pending)
+		_queueCancel(toUserData(fd, _completionFor(reg.events), reg.generation));
+	reg.registered = false;
+	reg.armed      = false;
+	reg.pending    = false;
+	reg.data       = NULL;
+	++reg.generation;
+	++reg.pollGeneration;
+}
+
+/* Submit queued requests and wait for completions, in one system call */
+int UringReactor::wait(std::vector< Event >& ready, int timeout) {
+	ready.clear( );
+
+	/* Data handed out with the previous events has been taken by now */
+	_recycleBuffers( );
+
+	/* (Re-)arm the requests of every socket that needs one */
+	for (size_t i = 0; i < _toArm.size( ); ++i) {
+		int           fd  = _toArm[i];
+		Registration& reg = _registrations[fd];
+		if (!reg.registered)
+			continue;
+		if (!reg.armed && _pollMask(reg.events))
+			_queuePoll(fd);
+		if (!reg.pending && _completionFor(reg.events) == ACCEPT_REQUEST)
+			_queueAccept(fd);
+		else if (!reg.pending && _completionFor(reg.events) == RECV_REQUEST)
+			_queueRecv(fd);
+	}
+	_toArm.clear( );
+
+	if (_submit(1, timeout) < 0 && errno != ETIME && errno != EBUSY)
+		return -1;
+
+	/* Reap every available completion */
+	unsigned head = *_cqHead;
+	unsigned tail = __atomic_load_n(_cqTail, __ATOMIC_ACQUIRE);
+	for (; head != tail; ++head) {
+		const io_uring_cqe* cqe = &_cqes[head & _cqMask];
+		if (cqe->user_data == URING_CANCEL_TAG)
+			continue;
+
+		int      fd         = (int)(cqe->user_data & 0xffffffff);
+		int      request    = (int)((cqe->user_data >> 32) & 0x3);
+		uint32_t generation = (uint32_t)(cqe->user_data >> 34);
+		bool     hasBuffer  = cqe->flags & IORING_CQE_F_BUFFER;
+		uint16_t bid        = cqe->flags >> IORING_CQE_BUFFER_SHIFT;
+
+		/* Completion of a request that was since cancelled or replaced, what it took is given back */
+		Registration* reg = (size_t)fd < _registrations.size( ) ? &_registrations[fd] : NULL;
+		if (!reg || !reg->registered
+		    || ((request == POLL_REQUEST ? reg->pollGeneration : reg->generation) & 0x3fffffff) != generation) {
+			if (hasBuffer)
+				_lent.push_back(bid);
+			if (request == ACCEPT_REQUEST && cqe->res >= 0)
+				close(cqe->res);
+			continue;
+		}
+
+		Event event = {.fd = fd, .data = reg->data, .events = 0, .result = cqe->res, .buffer = NULL};
+		if (request == ACCEPT_REQUEST) {
+			/* Accepting goes on across loop turns, until an error */
+			if (!(cqe->flags & IORING_CQE_F_MORE)) {
+				reg->pending = false;
+				_toArm.push_back(fd);
+			}
+			/* No multishot accept, the listener gets polled instead */
+			if (cqe->res == -EINVAL) {
+				_multishotAccept = false;
+				continue;
+			}
+			event.events = ACCEPT;
+		}
+		else if (request == RECV_REQUEST) {
+			reg->pending = false;
+			_toArm.push_back(fd);
+			/* Out of buffers, the socket is reported readable for the loop to read it itself */
+			if (cqe->res == -ENOBUFS || (cqe->res > 0 && !hasBuffer))
+				event.events = READABLE;
+			else
+				event.events = RECEIVE;
+			if (hasBuffer) {
+				event.buffer = _buffers + bid * RECV_BUFFER_SIZE;
+				_lent.push_back(bid);
+			}
+		}
+		else {
+			reg->armed = false;
+			_toArm.push_back(fd);
+			if (cqe->res < 0)
+				event.events = READABLE | HANGUP;
+			else {
+				if (cqe->res & POLLIN)
+					event.events |= READABLE;
+				if (cqe->res & POLLOUT)
+					event.events |= WRITABLE;
+				/* Hangups and errors are reported as readable so that the next read() sees them */
+				if (cqe->res & (POLLHUP | POLLERR | POLLRDHUP))
+					event.events |= READABLE | HANGUP;
+			}
+		}
+		ready.push_back(event);
+	}
+	__atomic_store_n(_cqHead, head, __ATOMIC_RELEASE);
+	return ready.size( );
+}
+
+/* Get a free submission queue entry, flushing the queue to the kernel if it is full */
+io_uring_sqe* UringReactor::_getSqe( ) {
+	if (*_sqTail - __atomic_load_n(_sqHead, __ATOMIC_ACQUIRE) >= _sqEntries)
+		_submit(0, -1);
+
+	unsigned      index = *_sqTail & _sqMask;
+	io_uring_sqe* sqe   = &_sqes[index];
+	std::memset(sqe, 0, sizeof(*sqe));
+	_sqArray[index] = index;
+	__atomic_store_n(_sqTail, *_sqTail + 1, __ATOMIC_RELEASE);
+	++_sqPending;
+	return sqe;
+}
+
+/* Hand pending entries to the kernel, optionally waiting for minComplete completions */
+int UringReactor::_submit(unsigned minComplete, int timeout) {
+	io_uring_getevents_arg arg;
+	__kernel_timespec      ts;
+	unsigned               flags = IORING_ENTER_EXT_ARG;
+
+	std::memset(&arg, 0, sizeof(arg));
+	arg.sigmask_sz = _NSIG / 8;
+	if (minComplete)
+		flags |= IORING_ENTER_GETEVENTS;
+	if (minComplete && timeout >= 0) {
+		ts.tv_sec  = timeout / 1000;
+		ts.tv_nsec = (timeout % 1000) * 1000000L;
+		arg.ts     = (uint64_t)(uintptr_t)&ts;
+	}
+
+	int ret = syscall(
+	  __NR_io_uring_enter, _ringfd, _sqPending, minComplete, flags, &arg, sizeof(arg));
+	/* Without SQPOLL, the kernel consumes submissions synchronously */
+	_sqPending = *_sqTail - __atomic_load_n(_sqHead, __ATOMIC_ACQUIRE);
+	return ret;
+}
+
+/* Queue a one-shot poll request for fd */
+void UringReactor::_queuePoll(int fd) {
+	Registration& reg = _registrations[fd];
+	io_uring_sqe* sqe = _getSqe( );
+
+	sqe->opcode        = IORING_OP_POLL_ADD;
+	sqe->fd            = fd;
+	sqe->poll32_events = _pollMask(reg.events);
+	sqe->user_data     = toUserData(fd, POLL_REQUEST, reg.pollGeneration);
+	reg.armed          = true;
+}
+
+/* Queue a multishot accept on a listener, accepted sockets are non-blocking and close-on-exec */
+void UringReactor::_queueAccept(int fd) {
+	Registration& reg = _registrations[fd];
+	io_uring_sqe* sqe = _getSqe( );
+
+	sqe->opcode       = IORING_OP_ACCEPT;
+	sqe->fd           = fd;
+	sqe->ioprio       = IORING_ACCEPT_MULTISHOT;
+	sqe->accept_flags = SOCK_NONBLOCK | SOCK_CLOEXEC;
+	sqe->user_data    = toUserData(fd, ACCEPT_REQUEST, reg.generation);
+	reg.pending       = true;
+}
+
+/* Queue a receive into whichever provided buffer is free when data arrives */
+void UringReactor::_queueRecv(int fd) {
+	Registration& reg = _registrations[fd];
+	io_uring_sqe* sqe = _getSqe( );
+
+	sqe->opcode    = IORING_OP_RECV;
+	sqe->fd        = fd;
+	sqe->len       = RECV_BUFFER_SIZE;
+	sqe->flags     = IOSQE_BUFFER_SELECT;
+	sqe->buf_group = URING_BUFFER_GROUP;
+	sqe->user_data = toUserData(fd, RECV_REQUEST, reg.generation);
+	reg.pending    = true;
+}
+
+/* Queue the cancellation of the request made with userData */
+void UringReactor::_queueCancel(uint64_t userData) {
+	io_uring_sqe* sqe = _getSqe( );
+
+	sqe->opcode    = IORING_OP_ASYNC_CANCEL;
+	sqe->fd        = -1;
+	sqe->addr      = userData;
+	sqe->user_data = URING_CANCEL_TAG;
+}
+
+#endif
@@ -0,0 +1,171 @@
+/* Channel membership regression check and microbenchmark. Random joins and parts are first
+ * replayed against a reference set, then member storage is timed against the std::map it
+ * replaced. Broadcasts carry an empty line, which recipients drop without queueing it, so
+ * the fanout time is the member walk itself. */
+
+/* Local Includes */
+#include "Broadcast.hpp"
+#include "Channel.hpp"
+#include "Client.hpp"
+#include "Config.hpp"
+#include "Logger.hpp"
+#include "Trace.hpp"
+#include "defines.h"
+
+/* System Includes */
+#include <cstdio>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+int g_status    = OFFLINE;
+int g_traceDump = 0;
+
+static const std::string s_empty;
+
+/* Reproducible xorshift sequence */
+static uint32_t random32( ) {
+	static uint32_t state = 0x9E3779B9;
+
+	state ^= state << 13;
+	state ^= state >> 17;
+	state ^= state << 5;
+	return state;
+}
+
+/* Member storage as it was before, a std::map walked for broadcasts */
+class MapChannel {
+	public:
+		void	addMember(Client* client, const std::string& reply) {
+			_members.insert(std::make_pair(client, Channel::Mode(0)));
+			sendToAll(reply);
+		}
+		void	removeMember(Client* client)	{ _members.erase(client); }
+		bool	isMember(Client* client) const	{ return _members.find(client) != _members.end( ); }
+		void	sendToAll(const std::string& reply) {
+			Broadcast broadcast(reply);
+			for (std::map<Client*, Channel::Mode>::iterator it = _members.begin( ); it != _members.end( ); ++it)
+				it->first->reply(broadcast.to(it->first));
+		}
+
+	private:
+		std::map<Client*, Channel::Mode>	_members;
+};
+
+/* Channel's view of each client must match the reference after every operation */
+static bool check(size_t nbClients, size_t nbOperations) {
+	std::vector<Client*> clients;
+	std::set<Client*>    reference;
+	Channel              channel("#check", NULL);
+	bool                 ok = true;
+
+	for (size_t i = 0; i < nbClients; ++i)
+		clients.push_back(new Client(-1));
+
+	for (size_t i = 0; ok && i < nbOperations; ++i) {
+		Client* client = clients[random32( ) % nbClients];
+
+		if (reference.count(client)) {
+			channel.removeMember(client);
+			reference.erase(client);
+		}
+		else {
+			channel.addMember(client, s_empty);
+			if (reference.empty( ))
+				channel.setMemberModes(client, C_OP);
+			reference.insert(client);
+		}
+
+		ok = channel.isMember(client) == (reference.count(client) == 1)
+		  && client->getChannels( ).size( ) == reference.count(client)
+		  && channel.getNbMembers( ) == reference.size( )
+		  && channel.getNbVisibleUsers( ) == reference.size( )
+		  && (reference.empty( ) || channel.getNbOperators( ) > 0);
+		/* Every now and then, make sure no other member was lost in the index */
+		for (size_t j = 0; ok && i % 16 == 0 && j < nbClients; ++j)
+			ok = channel.isMember(clients[j]) == (reference.count(clients[j]) == 1);
+		if (!ok)
+			std::fprintf(stderr, "chanbench: membership mismatch after %lu operations\n",
+			             (unsigned long)i + 1);
+	}
+
+	channel.closeChannel( );
+	for (size_t i = 0; i < nbClients; ++i)
+		delete clients[i];
+	return ok;
+}
+
+static double elapsed(uint64_t start, size_t count) {
+	return double(Trace::now( ) - start) / count;
+}
+
+/* Join every client, look members up, broadcast, then part every client */
+template <typename Storage>
+static void run(const char* name, Storage& storage, const std::vector<Client*>& clients) {
+	size_t   nbClients = clients.size( );
+	size_t   lookups   = 1000000;
+	size_t   fanouts   = 10000000 / nbClients + 1;
+	size_t   found     = 0;
+	uint64_t start;
+	double   joinNs, lookupNs, fanoutNs, partNs;
+
+	start = Trace::now( );
+	for (size_t i = 0; i < nbClients; ++i)
+		storage.addMember(clients[i], s_empty);
+	joinNs = elapsed(start, nbClients);
+
+	start = Trace::now( );
+	for (size_t i = 0; i < lookups; ++i)
+		found += storage.isMember(clients[random32( ) % nbClients]);
+	lookupNs = elapsed(start, lookups);
+
+	start = Trace::now( );
+	for (size_t i = 0; i < fanouts; ++i)
+		storage.sendToAll(s_empty);
+	fanoutNs = elapsed(start, fanouts * nbClients);
+
+	/* Parts go in a scrambled order, 7919 is coprime with every size */
+	start = Trace::now( );
+	for (size_t i = nbClients; i-- > 0;)
+		storage.removeMember(clients[(i * 7919) % nbClients]);
+	partNs = elapsed(start, nbClients);
+
+	std::printf("%-10s %8lu %12.1f %12.1f %12.1f %14.2f%s\n", name, (unsigned long)nbClients, joinNs,
+	            partNs, lookupNs, fanoutNs, found == lookups ? "" : "  (lookup miss)");
+}
+
+int main( ) {
+	Config config;
+
+	/* Keep join logs from dominating the timings */
+	config.logLevel = "error";
+	Logger::start(config);
+
+	if (!check(200, 100000) || !check(2000, 100000)) {
+		Logger::stop( );
+		return 1;
+	}
+	std::printf("membership check: ok\n\n");
+
+	static const size_t sizes[] = {10, 100, 1000, 10000};
+	std::printf("%-10s %8s %12s %12s %12s %14s\n", "storage", "members", "join ns", "part ns",
+	            "lookup ns", "fanout ns/mbr");
+	for (size_t s = 0; s < sizeof(sizes) / sizeof(*sizes); ++s) {
+		std::vector<Client*> clients;
+		for (size_t i = 0; i < sizes[s]; ++i)
+			clients.push_back(new Client(-1));
+
+		MapChannel before;
+		Channel    after("#bench", NULL);
+		run("std::map", before, clients);
+		run("Channel", after, clients);
+		after.closeChannel( );
+
+		for (size_t i = 0; i < clients.size( ); ++i)
+			delete clients[i];
+	}
+
+	Logger::stop( );
+	return 0;
+}
@@ -0,0 +1,214 @@
+/* Channel load generator. Connects clients to a running server, has them all join one channel,
+ * then each sends the same number of PRIVMSGs, keeping a window of messages in flight so that
+ * the receivers' send queues stay under the server limit. Prints the command and delivery
+ * throughput; the server logs its socket calls per command when it shuts down or dumps its
+ * traces (SIGUSR1), see README. */
+
+/* System Includes */
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <signal.h>
+#include <string>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+/* Messages sent and not yet relayed to every other client */
+static const size_t WINDOW = 1024;
+
+struct LoadClient {
+	int				fd;
+	std::string		out;		/* Bytes not written yet */
+	size_t			written;
+	std::string		in;			/* Partial line */
+	bool			joined;
+	size_t			sent;		/* PRIVMSGs queued in out */
+	size_t			received;	/* PRIVMSGs from the other clients */
+};
+
+static size_t s_nbMessages;		/* Per client, 0 until everyone joined */
+static size_t s_sent;
+static size_t s_delivered;
+static size_t s_expected;		/* Per client */
+
+static double seconds( ) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int connectTo(const char* host, int port) {
+	struct sockaddr_in addr;
+	int                fd = socket(AF_INET, SOCK_STREAM, 0);
+
+	std::memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_port   = htons(port);
+	if (fd < 0 || inet_pton(AF_INET, host, &addr.sin_addr) != 1
+	    || connect(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+		std::perror("loadgen: connect");
+		if (fd >= 0)
+			close(fd);
+		return -1;
+	}
+	fcntl(fd, F_SETFL, O_NONBLOCK);
+	return fd;
+}
+
+/* Count complete lines: the end of our own NAMES reply, and messages relayed to us */
+static void parseLines(LoadClient& client) {
+	size_t start = 0, end;
+
+	while ((end = client.in.find("\r\n", start)) != std::string::npos) {
+		std::string line = client.in.substr(start, end - start);
+		if (line.find(" PRIVMSG #load ") != std::string::npos) {
+			++client.received;
+			++s_delivered;
+		}
+		else if (line.find(" 366 ") != std::string::npos)
+			client.joined = true;
+		start = end + 2;
+	}
+	client.in.erase(0, start);
+}
+
+/* Queue messages round robin while the window allows it */
+static void refill(std::vector<LoadClient>& clients) {
+	size_t nbClients = clients.size( );
+	bool   queued    = true;
+
+	while (queued && s_sent - s_delivered / (nbClients - 1) < WINDOW) {
+		queued = false;
+		for (size_t i = 0; i < nbClients; ++i) {
+			char line[128];
+			if (clients[i].sent == s_nbMessages)
+				continue;
+			std::snprintf(line, sizeof(line), "PRIVMSG #load :message %lu from client %lu\r\n",
+			              (unsigned long)clients[i].sent, (unsigned long)i);
+			clients[i].out += line;
+			++clients[i].sent;
+			++s_sent;
+			queued = true;
+		}
+	}
+}
+
+/* Write and read whatever the sockets allow until done() holds or timeout seconds pass */
+template <typename Done>
+static bool pump(std::vector<LoadClient>& clients, Done done, double timeout) {
+	std::vector<struct pollfd> fds(clients.size( ));
+	double                     deadline = seconds( ) + timeout;
+	char                       buffer[65536];
+
+	while (!done(clients)) {
+		if (seconds( ) > deadline)
+			return false;
+		if (s_nbMessages)
+			refill(clients);
+		for (size_t i = 0; i < clients.size( ); ++i) {
+			fds[i].fd     = clients[i].fd;
+			fds[i].events = POLLIN | (clients[i].written < clients[i].out.size( ) ? POLLOUT : 0);
+		}
+		if (poll(&fds[0], fds.size( ), 100) < 0 && errno != EINTR)
+			return false;
+		for (size_t i = 0; i < clients.size( ); ++i) {
+			LoadClient& client = clients[i];
+			if (fds[i].revents & POLLOUT) {
+				ssize_t n = send(client.fd, client.out.data( ) + client.written,
+				                 client.out.size( ) - client.written, 0);
+				if (n > 0)
+					client.written += n;
+				if (client.written == client.out.size( )) {
+					client.out.clear( );
+					client.written = 0;
+				}
+			}
+			if (fds[i].revents & (POLLIN | POLLHUP | POLLERR)) {
+				ssize_t n = recv(client.fd, buffer, sizeof(buffer), 0);
+				if (n <= 0 && !(n < 0 && errno == EAGAIN)) {
+					std::fprintf(stderr, "loadgen: client %lu disconnected\n", (unsigned long)i);
+					return false;
+				}
+				if (n > 0) {
+					client.in.append(buffer, n);
+					parseLines(client);
+				}
+			}
+		}
+	}
+	return true;
+}
+
+static bool allJoined(const std::vector<LoadClient>& clients) {
+	for (size_t i = 0; i < clients.size( ); ++i)
+		if (!clients[i].joined)
+			return false;
+	return true;
+}
+
+static bool allReceived(const std::vector<LoadClient>& clients) {
+	for (size_t i = 0; i < clients.size( ); ++i)
+		if (clients[i].received < s_expected)
+			return false;
+	return true;
+}
+
+int main(int argc, char** argv) {
+	if (argc < 3 || (argc > 3 && std::atoi(argv[3]) < 2)) {
+		std::fprintf(stderr, "usage: %s <port> <password> [clients >= 2] [messages] [host]\n", argv[0]);
+		return 1;
+	}
+	int         port       = std::atoi(argv[1]);
+	size_t      nbClients  = argc > 3 ? std::strtoul(argv[3], NULL, 10) : 20;
+	size_t      nbMessages = argc > 4 ? std::strtoul(argv[4], NULL, 10) : 1000;
+	const char* host       = argc > 5 ? argv[5] : "127.0.0.1";
+
+	/* A server going away shows up as a failed recv */
+	signal(SIGPIPE, SIG_IGN);
+
+	std::vector<LoadClient> clients(nbClients);
+	for (size_t i = 0; i < nbClients; ++i) {
+		char registration[256];
+		if ((clients[i].fd = connectTo(host, port)) < 0)
+			return 1;
+		/* Nicks differ between runs, those of the previous one may still be in use */
+		std::snprintf(registration, sizeof(registration),
+		              "PASS %s\r\nNICK l%03d%05lu\r\nUSER load 0 * :loadgen\r\nJOIN #load\r\n", argv[2],
+		              getpid( ) % 1000, (unsigned long)i);
+		clients[i].out      = registration;
+		clients[i].written  = 0;
+		clients[i].joined   = false;
+		clients[i].sent     = 0;
+		clients[i].received = 0;
+	}
+	if (!pump(clients, allJoined, 10)) {
+		std::fprintf(stderr, "loadgen: clients did not all join #load\n");
+		return 1;
+	}
+
+	s_nbMessages = nbMessages;
+	s_expected   = (nbClients - 1) * nbMessages;
+
+	double start = seconds( );
+	bool   done  = pump(clients, allReceived, 60);
+	double time  = seconds( ) - start;
+
+	for (size_t i = 0; i < nbClients; ++i)
+		close(clients[i].fd);
+	std::printf("%lu clients, %lu commands in %.3f s: %.0f commands/s, %.0f deliveries/s\n",
+	            (unsigned long)nbClients, (unsigned long)s_sent, time, s_sent / time, s_delivered / time);
+	if (!done) {
+		std::fprintf(stderr, "loadgen: %lu of %lu deliveries before the timeout\n",
+		             (unsigned long)s_delivered, (unsigned long)(s_expected * nbClients));
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,123 @@
+/* Message parser microbenchmark. A corpus of typical client lines is parsed over and over,
+ * every parameter being read back as commands do, by the one-pass Message parser and by the
+ * string splitting parser it replaced. */
+
+/* Local Includes */
+#include "Message.hpp"
+#include "Trace.hpp"
+#include "defines.h"
+
+/* System Includes */
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+int g_status    = OFFLINE;
+int g_traceDump = 0;
+
+/* Parsing results end up here, so that the work cannot be optimized out */
+static volatile size_t s_sink;
+
+/* Lines as framed by the client, "\r\n" included */
+static const char* const s_corpus[] = {
+	"PRIVMSG #general :hey everyone, did the build go green after the last merge?\r\n",
+	":alice!alice@10.0.0.12 PRIVMSG #general :yes, all the backends pass now\r\n",
+	"@time=2024-05-01T12:00:00.000Z;msgid=6630a1b2-4f PRIVMSG #ops :tagged line\r\n",
+	"JOIN #general,#random,#ops key1,key2\r\n",
+	"PART #random :see you later\r\n",
+	"MODE #ops +o bob\r\n",
+	"KICK #general mallory :flooding the channel\r\n",
+	"TOPIC #general :Release planning, Thursday 14:00 UTC\r\n",
+	"NOTICE bob :your build finished\r\n",
+	"PING :irc.example.net\r\n",
+	"NICK carol\r\n",
+	"USER carol 0 * :Carol Example\r\n",
+	"WHO #general\r\n",
+	"CAP REQ :message-tags server-time\r\n",
+};
+
+/* The parser as it was before: substr and erase on a copy of the line */
+struct LegacyMessage {
+	std::string					cmd;
+	std::string					prefix;
+	std::vector<std::string>	middle;
+	std::string					trailing;
+
+	explicit LegacyMessage(std::string raw) {
+		size_t pos = 0;
+
+		if (raw.at(0) == ':') {
+			pos    = raw.find(' ');
+			prefix = raw.substr(1, pos);
+			raw.erase(0, pos + 1);
+		}
+		if ((pos = raw.find(" :")) != std::string::npos) {
+			trailing = raw.substr(pos + 2, raw.size( ));
+			raw      = raw.substr(0, pos + 2);
+			if ((pos = trailing.find("\r\n")) != std::string::npos)
+				trailing = trailing.substr(0, pos);
+		}
+		while ((pos = raw.find(' ')) != std::string::npos || (pos = raw.find("\r\n")) != std::string::npos) {
+			middle.push_back(raw.substr(0, pos));
+			raw.erase(0, pos + 1);
+		}
+		if (!middle.empty( )) {
+			cmd = middle.at(0);
+			middle.erase(middle.begin( ));
+			std::transform(cmd.begin( ), cmd.end( ), cmd.begin( ), ::tolower);
+		}
+	}
+};
+
+/* Commands used to copy the parameters out of the message */
+static size_t readLegacy(const char* line, size_t length) {
+	LegacyMessage            msg(std::string(line, length));
+	std::vector<std::string> args  = msg.middle;
+	size_t                   total = msg.cmd.size( ) + msg.prefix.size( ) + msg.trailing.size( );
+
+	for (size_t i = 0; i < args.size( ); ++i)
+		total += args[i].size( );
+	return total;
+}
+
+/* Parameters are views, the line ending is stripped by the framing */
+static size_t readMessage(const char* line, size_t length) {
+	Message msg(NULL, line, length - 2);
+	size_t  total = msg.getCommand( ).size( ) + msg.getPrefix( ).size( ) + msg.getTrailing( ).size( );
+
+	for (size_t i = 0; i < msg.getMiddleCount( ); ++i)
+		total += msg.getMiddle(i).size( );
+	return total;
+}
+
+static void run(const char* name, size_t (*parse)(const char*, size_t), size_t passes) {
+	static const size_t nbLines = sizeof(s_corpus) / sizeof(*s_corpus);
+	size_t              lengths[nbLines];
+	size_t              bytes    = 0;
+	size_t              checksum = 0;
+
+	for (size_t i = 0; i < nbLines; ++i) {
+		lengths[i] = std::strlen(s_corpus[i]);
+		bytes += lengths[i];
+	}
+
+	uint64_t start = Trace::now( );
+	for (size_t pass = 0; pass < passes; ++pass)
+		for (size_t i = 0; i < nbLines; ++i)
+			checksum += parse(s_corpus[i], lengths[i]);
+	double ns = double(Trace::now( ) - start);
+	s_sink    = checksum;
+
+	std::printf("%-10s %10lu %12.1f %10.1f\n", name, (unsigned long)(passes * nbLines),
+	            ns / (passes * nbLines), bytes * passes / (ns / 1e9) / (1 << 20));
+}
+
+int main( ) {
+	std::printf("%-10s %10s %12s %10s\n", "parser", "messages", "ns/message", "MB/s");
+	run("legacy", readLegacy, 20000);
+	run("Message", readMessage, 20000);
+	return 0;
+}
@@ -0,0 +1,129 @@
+/* Decode flight recorder dumps (ircserv-<pid>-<loop>.trace) into text and per-command
+ * dispatch time summaries. Dumps of several loops are merged on their common clock. */
+
+/* Local Includes */
+#include "Trace.hpp"
+
+/* System Includes */
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+struct Entry {
+	Trace::Event	event;
+	uint32_t		loop;
+	std::string		command;
+
+	bool			operator<(const Entry& rhs) const { return event.time < rhs.event.time; }
+};
+
+static bool load(const char* path, std::vector<Entry>& entries) {
+	FILE*         file = std::fopen(path, "rb");
+	Trace::Header header;
+
+	if (!file) {
+		std::perror(path);
+		return false;
+	}
+	if (std::fread(&header, sizeof(header), 1, file) != 1
+	    || std::memcmp(header.magic, "IRCTRACE", sizeof(header.magic)) != 0
+	    || header.version != Trace::VERSION) {
+		std::fprintf(stderr, "%s: not a trace dump\n", path);
+		std::fclose(file);
+		return false;
+	}
+
+	std::vector<std::string> names;
+	char                     name[Trace::NAME_SIZE];
+	for (uint32_t i = 0; i < header.nbCommands; ++i) {
+		if (std::fread(name, sizeof(name), 1, file) != 1)
+			break;
+		name[sizeof(name) - 1] = '\0';
+		names.push_back(name);
+	}
+
+	Entry entry;
+	entry.loop = header.loop;
+	for (uint32_t i = 0; i < header.nbEvents; ++i) {
+		if (std::fread(&entry.event, sizeof(entry.event), 1, file) != 1) {
+			std::fprintf(stderr, "%s: truncated after %u events\n", path, i);
+			break;
+		}
+		entry.command = (entry.event.command < names.size( )) ? names[entry.event.command] : "?";
+		entries.push_back(entry);
+	}
+	std::fclose(file);
+	return true;
+}
+
+static void printEvents(const std::vector<Entry>& entries) {
+	static const char* const types[] = {"?", "ACCEPT", "READ", "DISPATCH", "REPLY", "DISCONNECT"};
+
+	for (size_t i = 0; i < entries.size( ); ++i) {
+		const Trace::Event& event = entries[i].event;
+		const char*         type  = types[event.type <= Trace::DISCONNECT ? event.type : 0];
+
+		std::printf("%14.6f ms  loop %-2u fd %-5u %-10s", (event.time - entries[0].event.time) / 1e6,
+		            entries[i].loop, event.fd, type);
+		if (event.type == Trace::READ || event.type == Trace::REPLY)
+			std::printf(" %u bytes", event.value);
+		else if (event.type == Trace::DISPATCH)
+			std::printf(" %-10s %.3f us", entries[i].command.c_str( ), event.value / 1e3);
+		std::printf("\n");
+	}
+}
+
+/* Dispatch times per command, slowest in total first */
+static void printSummary(const std::vector<Entry>& entries) {
+	typedef std::map<std::string, std::vector<uint32_t> > Timings;
+	Timings timings;
+
+	for (size_t i = 0; i < entries.size( ); ++i)
+		if (entries[i].event.type == Trace::DISPATCH)
+			timings[entries[i].command].push_back(entries[i].event.value);
+
+	std::vector<std::pair<uint64_t, std::string> > order;
+	for (Timings::iterator it = timings.begin( ); it != timings.end( ); ++it) {
+		uint64_t total = 0;
+		for (size_t i = 0; i < it->second.size( ); ++i)
+			total += it->second[i];
+		std::sort(it->second.begin( ), it->second.end( ));
+		order.push_back(std::make_pair(total, it->first));
+	}
+	std::sort(order.rbegin( ), order.rend( ));
+
+	std::printf("%-12s %9s %12s %10s %10s %10s %10s\n", "command", "calls", "total us", "mean us",
+	            "p50 us", "p99 us", "max us");
+	for (size_t i = 0; i < order.size( ); ++i) {
+		const std::vector<uint32_t>& times = timings[order[i].second];
+		std::printf("%-12s %9lu %12.1f %10.3f %10.3f %10.3f %10.3f\n", order[i].second.c_str( ),
+		            (unsigned long)times.size( ), order[i].first / 1e3,
+		            order[i].first / 1e3 / times.size( ), times[times.size( ) / 2] / 1e3,
+		            times[(times.size( ) * 99) / 100] / 1e3, times.back( ) / 1e3);
+	}
+}
+
+int main(int argc, char** argv) {
+	std::vector<Entry> entries;
+	bool               summaryOnly = (argc > 1 && std::strcmp(argv[1], "-s") == 0);
+	int                first       = summaryOnly ? 2 : 1;
+
+	if (argc <= first) {
+		std::fprintf(stderr, "usage: %s [-s] <dump>...\n", argv[0]);
+		return 1;
+	}
+	for (int i = first; i < argc; ++i)
+		if (!load(argv[i], entries))
+			return 1;
+
+	std::stable_sort(entries.begin( ), entries.end( ));
+	if (!summaryOnly && !entries.empty( )) {
+		printEvents(entries);
+		std::printf("\n");
+	}
+	printSummary(entries);
+	return 0;
+}